@@ -0,0 +1,167 @@
+#if !defined(ASCII_TREE_BATCH_H)
+#define ASCII_TREE_BATCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "grammar.hpp"
+
+namespace ascii_tree
+{
+    // Parses many independent inputs on a pool of worker threads that live as
+    // long as the batch_parser. Each batch is dealt out to the workers as one
+    // contiguous range apiece; a worker that finishes its own range steals
+    // inputs from the others' ranges. Every worker tokenizes into its own
+    // scratch buffer, reused from one input and one batch to the next, so the
+    // only allocations per input are its result's.
+    class batch_parser
+    {
+        struct range_
+        {
+            std::atomic<size_t> next;
+            size_t end;
+        };
+
+        std::vector<std::thread> workers_;
+        std::unique_ptr<range_[]> ranges_;
+
+        std::mutex batch_mutex_; // one batch at a time
+        std::mutex m_;
+        std::condition_variable start_;
+        std::condition_variable done_;
+        size_t generation_;
+        size_t running_;
+        bool stopping_;
+        std::function<void(size_t, std::vector<token_ref>&)> parse_one_;
+
+        bool claim_(size_t range, size_t& index)
+        {
+            if (ranges_[range].next.load(std::memory_order_relaxed) >= ranges_[range].end) { return false; }
+            index = ranges_[range].next.fetch_add(1, std::memory_order_relaxed);
+            return index < ranges_[range].end;
+        }
+
+        void run_(size_t self)
+        {
+            std::vector<token_ref> scratch;
+            size_t seen = 0;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_);
+                    start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                    if (stopping_) { return; }
+                    seen = generation_;
+                }
+
+                size_t index;
+                for (size_t i = 0; i < workers_.size(); ++i)
+                {
+                    size_t victim = (self + i) % workers_.size(); // our own range first
+                    while (claim_(victim, index))
+                    {
+                        parse_one_(index, scratch);
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(m_);
+                if (--running_ == 0) { done_.notify_one(); }
+            }
+        }
+
+    public:
+        explicit batch_parser(unsigned threads = std::thread::hardware_concurrency())
+            : generation_(0), running_(0), stopping_(false)
+        {
+            threads = std::max(threads, 1u);
+            ranges_.reset(new range_[threads]);
+            for (unsigned i = 0; i < threads; ++i)
+            {
+                ranges_[i].next = 0;
+                ranges_[i].end = 0;
+            }
+
+            workers_.reserve(threads);
+            for (unsigned i = 0; i < threads; ++i)
+            {
+                workers_.emplace_back([this, i] { run_(i); });
+            }
+        }
+
+        batch_parser(const batch_parser&) = delete;
+        batch_parser& operator=(const batch_parser&) = delete;
+
+        ~batch_parser()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_);
+                stopping_ = true;
+            }
+            start_.notify_all();
+
+            for (auto& worker : workers_) { worker.join(); }
+        }
+
+        // inputs is any random-access container of things convertible to
+        // std::string_view; they are borrowed only until parse() returns
+        template<class Inputs>
+        std::vector<parse_result<std::vector<token>>> parse(const Inputs& inputs)
+        {
+            std::lock_guard<std::mutex> batch_lock(batch_mutex_);
+
+            size_t count = inputs.size();
+            std::vector<parse_result<std::vector<token>>> results(count, parse_result<std::vector<token>>(std::vector<token>()));
+            if (count == 0) { return results; }
+
+            parse_one_ = [&](size_t index, std::vector<token_ref>& scratch)
+            {
+                grammar g{ std::string_view(inputs[index]) };
+                scratch.clear();
+
+                token_ref ref{};
+                while (g.next(ref))
+                {
+                    scratch.push_back(ref);
+                }
+
+                if (g.failed())
+                {
+                    results[index] = parse_result<std::vector<token>>(g.error());
+                    return;
+                }
+
+                auto& tokens = results[index].value();
+                tokens.reserve(scratch.size());
+                for (auto& scratch_ref : scratch)
+                {
+                    tokens.push_back(g.to_token(scratch_ref));
+                }
+            };
+
+            size_t threads = workers_.size();
+            for (size_t i = 0; i < threads; ++i)
+            {
+                ranges_[i].next = count * i / threads;
+                ranges_[i].end = count * (i + 1) / threads;
+            }
+
+            std::unique_lock<std::mutex> lock(m_);
+            running_ = threads;
+            ++generation_;
+            start_.notify_all();
+            done_.wait(lock, [&] { return running_ == 0; });
+
+            parse_one_ = nullptr;
+            return results;
+        }
+    };
+}
+
+#endif // ASCII_TREE_BATCH_H
@@ -0,0 +1,447 @@
+// Throughput benchmarks for the parser, grammar, tree and batch_parser over the
+// synthetic corpora in corpus.hpp. Each benchmark runs until --min-time has
+// passed and reports bytes/s, tokens/s (terminals/s for the parser benchmarks)
+// and heap allocations per run, counted by replacing the global operator new.
+//
+//   ascii_tree_bench [--size BYTES] [--min-time SECONDS] [--filter TEXT]
+//   ascii_tree_bench --corpus KIND [--size BYTES] > file
+//
+// BYTES takes a K, M or G suffix; the default is 1M. --corpus writes a corpus
+// (tiny, wide, deep, padding, invalid, box or broad) to stdout instead.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+#include "../batch.hpp"
+#include "../dfa_lexer.hpp"
+#include "../grammar.hpp"
+#include "../instrumentation.hpp"
+#include "../line_index.hpp"
+#include "../parse_cache.hpp"
+#include "../parser.hpp"
+#include "../tree.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+    std::atomic<size_t> allocations{ 0 };
+}
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned forms
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t alignment = std::max(static_cast<size_t>(align), sizeof(void*));
+    void* p = nullptr;
+#if defined(_MSC_VER)
+    p = _aligned_malloc(size ? size : 1, alignment);
+#else
+    if (posix_memalign(&p, alignment, size ? size : 1) != 0) { p = nullptr; }
+#endif
+    if (p) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+#if defined(_MSC_VER)
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+namespace
+{
+    using namespace ascii_tree;
+    using namespace ascii_tree::bench;
+
+    // keeps the optimizer from dropping work whose result is otherwise unused
+    volatile size_t sink;
+
+    // the baseline for classify/table: terminal_traits::to_terminal() as it
+    // was before the table, a chain of compares with the locale's isalnum()
+    terminal chain_classify(char ch)
+    {
+        if (ch == '[') return open_square_brace;
+        else if (ch == '*') return asterisk;
+        else if (ch == ']') return close_square_brace;
+        else if (std::isalnum(static_cast<unsigned char>(ch)) || ch == '_') return name_char;
+        else if (ch == '-') return dash;
+        else if (ch == '(') return open_paren;
+        else if (ch == ')') return close_paren;
+        else if (ch == '\\') return backslash;
+        else if (ch == '|') return pipe;
+        else if (ch == '/') return slash;
+        else if (ch == ' ') return space;
+        return none;
+    }
+
+    // owns its lines rather than viewing text, so a corpus can be moved (e.g.
+    // when the vector holding it grows) without leaving them dangling
+    struct corpus
+    {
+        std::string text;
+        std::vector<std::string> lines; // for the one-diagram-per-line kinds
+
+        corpus(corpus_kind kind, size_t bytes) : text(make_corpus(kind, bytes))
+        {
+            if (kind == corpus_kind::tiny || kind == corpus_kind::invalid)
+            {
+                line_index index(text);
+                for (size_t row = 0; row < index.rows(); ++row)
+                {
+                    if (!index.line(row).empty()) { lines.emplace_back(index.line(row)); }
+                }
+            }
+        }
+    };
+
+    struct benchmark
+    {
+        const char* name;
+        corpus_kind kind;
+        std::function<size_t(const corpus&)> run; // returns the number of tokens read
+    };
+
+    const char* kind_name(corpus_kind kind)
+    {
+        switch (kind)
+        {
+        case corpus_kind::tiny: return "tiny";
+        case corpus_kind::wide: return "wide";
+        case corpus_kind::deep: return "deep";
+        case corpus_kind::padding: return "padding";
+        case corpus_kind::invalid: return "invalid";
+        case corpus_kind::box: return "box";
+        case corpus_kind::broad: return "broad";
+        }
+        return "?";
+    }
+
+    bool parse_kind(const char* s, corpus_kind& kind)
+    {
+        for (auto k : { corpus_kind::tiny, corpus_kind::wide, corpus_kind::deep, corpus_kind::padding, corpus_kind::invalid, corpus_kind::box, corpus_kind::broad })
+        {
+            if (std::strcmp(s, kind_name(k)) == 0) { kind = k; return true; }
+        }
+        return false;
+    }
+
+    size_t parse_size(const char* s)
+    {
+        char* suffix;
+        size_t n = std::strtoull(s, &suffix, 10);
+        switch (*suffix)
+        {
+        case 'G': case 'g': n <<= 10; // fall through
+        case 'M': case 'm': n <<= 10; // fall through
+        case 'K': case 'k': n <<= 10;
+        }
+        return n;
+    }
+
+    std::vector<benchmark> benchmarks()
+    {
+        auto parse_terminals = [](const corpus& c)
+        {
+            parser<terminal_traits> p{ std::string_view(c.text) };
+            size_t terminals = 0;
+            for (;;)
+            {
+                p.ignore();
+                if (p.at_end()) { break; }
+                p.accept(terminal_traits::to_terminal(c.text[p.offset()]));
+                ++terminals;
+            }
+            return terminals;
+        };
+
+        auto tokens = [](const corpus& c)
+        {
+            return grammar(std::string_view(c.text)).tokens().size();
+        };
+
+        auto token_refs = [](const corpus& c)
+        {
+            return grammar(std::string_view(c.text)).token_refs().size();
+        };
+
+        auto next = [](const corpus& c)
+        {
+            grammar g{ std::string_view(c.text) };
+            token_ref ref{};
+            size_t count = 0;
+            while (g.next(ref)) { ++count; }
+            return count;
+        };
+
+        auto dfa_next = [](const corpus& c)
+        {
+            dfa_lexer lexer(c.text);
+            token_ref ref{};
+            size_t count = 0;
+            while (lexer.next(ref)) { ++count; }
+            return count;
+        };
+
+        auto build_tree = [](const corpus& c)
+        {
+            grammar g{ std::string_view(c.text) };
+            return tree(g).size();
+        };
+
+        return {
+            { "classify/chain", corpus_kind::wide, [](const corpus& c)
+                {
+                    size_t sum = 0;
+                    for (char ch : c.text) { sum += chain_classify(ch); }
+                    sink = sum;
+                    return size_t(0);
+                } },
+            { "classify/table", corpus_kind::wide, [](const corpus& c)
+                {
+                    size_t sum = 0;
+                    for (char ch : c.text) { sum += terminal_traits::to_terminal(ch); }
+                    sink = sum;
+                    return size_t(0);
+                } },
+
+            { "parser/accept+ignore", corpus_kind::wide, parse_terminals },
+            { "parser/accept+ignore", corpus_kind::padding, parse_terminals },
+
+            // one-terminal lookahead by copying an owning parser, as grammar once
+            // did, and by rewinding to a position
+            { "parser/lookahead_copy", corpus_kind::wide, [](const corpus& c)
+                {
+                    parser<terminal_traits> p{ std::string(c.text) };
+                    size_t terminals = 0;
+                    for (; !p.at_end(); ++terminals)
+                    {
+                        auto peek = p;
+                        peek.accept(open_square_brace);
+                        p.accept(terminal_traits::to_terminal(c.text[p.offset()]));
+                    }
+                    return terminals;
+                } },
+            { "parser/lookahead_rewind", corpus_kind::wide, [](const corpus& c)
+                {
+                    parser<terminal_traits> p{ std::string(c.text) };
+                    size_t terminals = 0;
+                    for (; !p.at_end(); ++terminals)
+                    {
+                        auto start = p.current_position();
+                        p.accept(open_square_brace);
+                        p.rewind(start);
+                        p.accept(terminal_traits::to_terminal(c.text[p.offset()]));
+                    }
+                    return terminals;
+                } },
+
+            { "grammar/tokens", corpus_kind::wide, tokens },
+            { "grammar/tokens", corpus_kind::padding, tokens },
+            { "grammar/append_tokens", corpus_kind::wide, [](const corpus& c)
+                {
+                    static std::vector<token> reused; // keeps its capacity from run to run
+                    reused.clear();
+                    return grammar(std::string_view(c.text)).append_tokens(reused);
+                } },
+            { "grammar/token_refs", corpus_kind::wide, token_refs },
+            { "grammar/token_refs", corpus_kind::padding, token_refs },
+            { "grammar/token_refs_counted", corpus_kind::wide, [](const corpus& c)
+                {
+                    return basic_grammar<counting_instrumentation>(std::string_view(c.text)).token_refs().size();
+                } },
+            { "grammar/interned_tokens", corpus_kind::wide, [](const corpus& c)
+                {
+                    symbol_table symbols;
+                    return grammar(std::string_view(c.text)).interned_tokens(symbols).size();
+                } },
+            { "grammar/next", corpus_kind::wide, next },
+            { "grammar/next", corpus_kind::padding, next },
+            { "grammar/next_owning", corpus_kind::wide, [](const corpus& c)
+                {
+                    grammar g{ std::string(c.text) };
+                    token_ref ref{};
+                    size_t count = 0;
+                    while (g.next(ref)) { ++count; }
+                    return count;
+                } },
+
+            { "dfa_lexer/next", corpus_kind::wide, dfa_next },
+            { "dfa_lexer/next", corpus_kind::padding, dfa_next },
+
+            { "grammar/located_tokens", corpus_kind::deep, [](const corpus& c)
+                {
+                    return grammar(std::string_view(c.text)).located_tokens().size();
+                } },
+            { "grammar/located_tokens", corpus_kind::box, [](const corpus& c)
+                {
+                    return grammar::from_box_drawing(c.text).located_tokens().size();
+                } },
+            { "grammar/located_tokens_parallel", corpus_kind::deep, [](const corpus& c)
+                {
+                    return grammar(std::string_view(c.text)).located_tokens_parallel().size();
+                } },
+
+            { "tree/build", corpus_kind::wide, build_tree },
+            { "tree/build", corpus_kind::deep, build_tree },
+            { "tree/build", corpus_kind::box, [](const corpus& c)
+                {
+                    auto g = grammar::from_box_drawing(c.text);
+                    return tree(g).size();
+                } },
+            { "tree/build", corpus_kind::broad, build_tree },
+
+            { "batch/parse", corpus_kind::tiny, [](const corpus& c)
+                {
+                    static batch_parser parser;
+                    size_t count = 0;
+                    for (auto& result : parser.parse(c.lines)) { count += result.value().size(); }
+                    return count;
+                } },
+
+            // after the warm-up run every line is a hit, as long as they all fit
+            { "token_cache/get", corpus_kind::tiny, [](const corpus& c)
+                {
+                    static token_cache cache(1 << 20);
+                    size_t count = 0;
+                    for (std::string_view line : c.lines) { count += cache.get(line)->result.value().size(); }
+                    return count;
+                } },
+            { "grammar/try_tokens", corpus_kind::tiny, [](const corpus& c)
+                {
+                    size_t count = 0;
+                    for (std::string_view line : c.lines) { count += grammar(line).try_tokens().value().size(); }
+                    return count;
+                } },
+
+            // the same rejections reported by exception and by value
+            { "reject/throw", corpus_kind::invalid, [](const corpus& c)
+                {
+                    size_t count = 0;
+                    for (std::string_view line : c.lines)
+                    {
+                        try { count += grammar(line).tokens().size(); }
+                        catch (const parse_exception&) {}
+                    }
+                    return count;
+                } },
+            { "reject/try", corpus_kind::invalid, [](const corpus& c)
+                {
+                    size_t count = 0;
+                    for (std::string_view line : c.lines)
+                    {
+                        auto result = grammar(line).try_tokens();
+                        if (result) { count += result.value().size(); }
+                    }
+                    return count;
+                } },
+            { "reject/recover", corpus_kind::invalid, [](const corpus& c)
+                {
+                    return grammar(std::string_view(c.text)).recover_located_tokens().tokens.size();
+                } },
+        };
+    }
+
+    void run(const benchmark& b, const corpus& c, double min_time)
+    {
+        using clock = std::chrono::steady_clock;
+
+        size_t tokens = b.run(c); // warm up
+        size_t runs = 0;
+        size_t allocations_before = allocations.load();
+        auto start = clock::now();
+        double elapsed;
+        do
+        {
+            b.run(c);
+            ++runs;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < min_time);
+        size_t allocated = allocations.load() - allocations_before;
+
+        double seconds = elapsed / runs;
+        std::printf("%-32s %-8s %12zu %10.1f ", b.name, kind_name(b.kind), c.text.size(), c.text.size() / seconds / 1e6);
+        if (tokens) { std::printf("%10.2f", tokens / seconds / 1e6); }
+        else { std::printf("%10s", "-"); }
+        std::printf(" %12.1f\n", double(allocated) / runs);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = 1 << 20;
+    double min_time = 0.5;
+    const char* filter = "";
+    const char* corpus_arg = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = i + 1 < argc;
+        if (has_value && std::strcmp(argv[i], "--size") == 0) { size = parse_size(argv[++i]); }
+        else if (has_value && std::strcmp(argv[i], "--min-time") == 0) { min_time = std::atof(argv[++i]); }
+        else if (has_value && std::strcmp(argv[i], "--filter") == 0) { filter = argv[++i]; }
+        else if (has_value && std::strcmp(argv[i], "--corpus") == 0) { corpus_arg = argv[++i]; }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--size BYTES] [--min-time SECONDS] [--filter TEXT] [--corpus KIND]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (corpus_arg)
+    {
+        corpus_kind kind;
+        if (!parse_kind(corpus_arg, kind))
+        {
+            std::fprintf(stderr, "unknown corpus '%s'\n", corpus_arg);
+            return 2;
+        }
+        auto text = make_corpus(kind, size);
+        std::fwrite(text.data(), 1, text.size(), stdout);
+        return 0;
+    }
+
+    std::printf("%-32s %-8s %12s %10s %10s %12s\n", "benchmark", "corpus", "bytes", "MB/s", "Mtok/s", "allocs/run");
+
+    std::vector<std::pair<corpus_kind, corpus>> corpora;
+    for (auto& b : benchmarks())
+    {
+        std::string label = std::string(b.name) + "/" + kind_name(b.kind);
+        if (label.find(filter) == std::string::npos) { continue; }
+
+        auto found = std::find_if(corpora.begin(), corpora.end(), [&](auto& entry) { return entry.first == b.kind; });
+        if (found == corpora.end())
+        {
+            corpora.emplace_back(b.kind, corpus(b.kind, size));
+            found = corpora.end() - 1;
+        }
+
+        run(b, found->second, min_time);
+    }
+
+    return 0;
+}
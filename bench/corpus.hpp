@@ -0,0 +1,176 @@
+#if !defined(ASCII_TREE_BENCH_CORPUS_H)
+#define ASCII_TREE_BENCH_CORPUS_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic diagrams for the benchmarks. A kind, size and seed always give the
+// same bytes on every platform: only raw mt19937 output is used, never a
+// <random> distribution, whose results are implementation-defined.
+//
+//   tiny     one small diagram per line, e.g. for batch_parser
+//   wide     a single line of nodes joined by horizontal edges
+//   deep     a multi-line tree, one level per pair of rows
+//   padding  like wide, but with runs of spaces between and inside tokens
+//   invalid  like tiny, but about half the lines have a bad char or are cut short
+//   box      like deep, but drawn in UTF-8 box-drawing chars (U+2500, U+2502)
+//   broad    one row of nodes joined by horizontal edges, each with a child
+//            hanging below it by a '|', so every row is as wide as the input
+//
+// Every kind but invalid is a valid tree. Each corpus stops at the first
+// diagram (or, for wide and padding, the first edge) that reaches the size.
+
+namespace ascii_tree { namespace bench
+{
+    enum class corpus_kind { tiny, wide, deep, padding, invalid, box, broad };
+
+    class corpus_writer_
+    {
+        std::mt19937 rng_;
+        size_t pad_;
+        bool box_;
+
+    public:
+        std::string text;
+
+        corpus_writer_(uint32_t seed, size_t pad, bool box = false) : rng_(seed), pad_(pad), box_(box) {}
+
+        size_t below(size_t n) { return rng_() % n; }
+
+        void pad()
+        {
+            if (pad_) { text.append(below(pad_ + 1), ' '); }
+        }
+
+        void name()
+        {
+            static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+            size_t length = 1 + below(8);
+            for (size_t i = 0; i < length; ++i)
+            {
+                text += chars[below(sizeof(chars) - 1)];
+            }
+        }
+
+        void root_node()
+        {
+            text += '['; pad(); text += '*'; pad(); text += ']';
+        }
+
+        void dashes(size_t count)
+        {
+            for (size_t i = 0; i < count; ++i) { text += box_ ? "\xE2\x94\x80" : "-"; }
+        }
+
+        void named_node()
+        {
+            text += '['; pad(); name(); pad(); text += ']';
+        }
+
+        void horizontal_edge()
+        {
+            dashes(1 + below(3)); pad();
+            text += '('; pad(); name(); pad(); text += ')'; pad();
+            dashes(1 + below(3));
+        }
+
+        // [*]-(a)-[b], with zero to two more edges and nodes
+        void small_diagram()
+        {
+            root_node();
+            for (size_t edges = 1 + below(3); edges > 0; --edges)
+            {
+                pad(); horizontal_edge(); pad(); named_node();
+            }
+        }
+    };
+
+    inline std::string make_corpus(corpus_kind kind, size_t bytes, uint32_t seed = 1)
+    {
+        corpus_writer_ w(seed, kind == corpus_kind::padding ? 16 : 0, kind == corpus_kind::box);
+        w.text.reserve(bytes + 64);
+
+        switch (kind)
+        {
+        case corpus_kind::tiny:
+            while (w.text.size() < bytes)
+            {
+                w.small_diagram();
+                w.text += '\n';
+            }
+            break;
+
+        case corpus_kind::wide:
+        case corpus_kind::padding:
+            w.root_node();
+            while (w.text.size() < bytes)
+            {
+                w.pad(); w.horizontal_edge(); w.pad(); w.named_node();
+            }
+            break;
+
+        case corpus_kind::deep:
+        case corpus_kind::box:
+            // each level is a row of nodes joined by horizontal edges whose
+            // first node hangs by a '|' from the first node of the row above
+            w.root_node();
+            while (w.text.size() < bytes)
+            {
+                w.text += kind == corpus_kind::box ? "\n \xE2\x94\x82\n" : "\n |\n";
+                w.named_node();
+                for (size_t siblings = w.below(4); siblings > 0; --siblings)
+                {
+                    w.horizontal_edge(); w.named_node();
+                }
+            }
+            w.text += '\n';
+            break;
+
+        case corpus_kind::broad:
+        {
+            std::vector<size_t> columns{ 0 };
+            w.root_node();
+            while (w.text.size() * 3 < bytes)
+            {
+                w.horizontal_edge();
+                columns.push_back(w.text.size());
+                w.named_node();
+            }
+
+            size_t width = w.text.size();
+            std::string edges(width, ' '), children(width, ' ');
+            for (size_t i = 1; i < columns.size(); ++i)
+            {
+                edges[columns[i] + 1] = '|';
+                children.replace(columns[i], 3, "[c]");
+            }
+            w.text += '\n' + edges + '\n' + children + '\n';
+            break;
+        }
+
+        case corpus_kind::invalid:
+            while (w.text.size() < bytes)
+            {
+                size_t line_begin = w.text.size();
+                w.small_diagram();
+                switch (w.below(4))
+                {
+                case 0: // a char no token can hold
+                    w.text[line_begin + w.below(w.text.size() - line_begin)] = "!]#)"[w.below(4)];
+                    break;
+                case 1: // cut short
+                    w.text.resize(line_begin + 1 + w.below(w.text.size() - line_begin - 1));
+                    break;
+                }
+                w.text += '\n';
+            }
+            break;
+        }
+
+        return w.text;
+    }
+}}
+
+#endif // ASCII_TREE_BENCH_CORPUS_H
@@ -0,0 +1,364 @@
+#if !defined(ASCII_TREE_BINARY_H)
+#define ASCII_TREE_BINARY_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "grammar.hpp"
+#include "parser.hpp"
+#include "symbol_table.hpp"
+#include "tree.hpp"
+
+#if 0
+
+BINARY FORMAT, VERSION 1
+========================
+
+A header followed by flat arrays, each starting on an 8-byte boundary, in the
+writer's byte order (the header says which, and a reader refuses the other):
+
+    header                    magic "ASCTREE\0", version, byte order mark,
+                              token_count, node_count, root, pool_size, size
+    token names               span[token_count]
+    node parents              u64[node_count]
+    first child of each node  u64[node_count + 1]
+    children                  u64[node_count]
+    node names                span[node_count]
+    edge names                span[node_count]
+    token types               u8[token_count]
+    pool                      char[pool_size]
+
+A span is a u64 offset and a u64 length into the pool, which holds each
+distinct name once. node_count is 0 when no tree was written. The arrays are
+read in place, so making a binary_image is a header check, however big it is;
+binary_file (binary_file.hpp) also checks every node and token once
+(see well_formed()).
+
+#endif
+
+namespace ascii_tree
+{
+    namespace binary_format
+    {
+        inline constexpr char magic[8] = { 'A', 'S', 'C', 'T', 'R', 'E', 'E', '\0' };
+        inline constexpr uint32_t version = 1;
+        inline constexpr uint32_t byte_order_mark = 0x01020304;
+
+        struct header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order;
+            uint64_t token_count;
+            uint64_t node_count;
+            uint64_t root;
+            uint64_t pool_size;
+            uint64_t size; // of the whole image
+        };
+
+        struct span
+        {
+            uint64_t offset;
+            uint64_t length;
+        };
+
+        inline uint64_t align_(uint64_t n)
+        {
+            return (n + 7) & ~uint64_t(7);
+        }
+
+        // where each array starts, from the counts in the header
+        struct layout
+        {
+            uint64_t token_names, parents, child_begin, children, node_names, edge_names, token_types, pool, size;
+
+            layout(uint64_t token_count, uint64_t node_count, uint64_t pool_size)
+            {
+                token_names = align_(sizeof(header));
+                parents = token_names + token_count * sizeof(span);
+                child_begin = parents + node_count * sizeof(uint64_t);
+                children = child_begin + (node_count + 1) * sizeof(uint64_t);
+                node_names = children + node_count * sizeof(uint64_t);
+                edge_names = node_names + node_count * sizeof(span);
+                token_types = edge_names + node_count * sizeof(span);
+                pool = align_(token_types + token_count);
+                size = pool + pool_size;
+            }
+        };
+    }
+
+    // Writes tokens, and optionally the tree built from the same input, as a
+    // binary image that binary_image can read in place.
+    class binary_writer
+    {
+        symbol_table symbols_;
+        std::vector<binary_format::span> token_names_;
+        std::vector<uint8_t> token_types_;
+        const tree* tree_ = nullptr;
+
+        binary_format::span intern_(std::string_view name)
+        {
+            symbol_id id = symbols_.intern(name);
+            uint64_t offset = static_cast<uint64_t>(symbols_.name(id).data() - symbols_.pool().data());
+            return binary_format::span{ offset, name.size() };
+        }
+
+        template<class T>
+        static void put_(std::string& image, uint64_t at, const T* items, size_t count)
+        {
+            if (count) { std::memcpy(&image[at], items, count * sizeof(T)); }
+        }
+
+    public:
+        explicit binary_writer(const std::vector<token>& tokens)
+        {
+            token_names_.reserve(tokens.size());
+            token_types_.reserve(tokens.size());
+            for (auto& tok : tokens)
+            {
+                token_names_.push_back(intern_(tok.name));
+                token_types_.push_back(static_cast<uint8_t>(tok.type));
+            }
+        }
+
+        // the tree must outlive the writer
+        binary_writer(const std::vector<token>& tokens, const tree& t)
+            : binary_writer(tokens)
+        {
+            tree_ = &t;
+        }
+
+        std::string write()
+        {
+            size_t nodes = tree_ ? tree_->size() : 0;
+            std::vector<uint64_t> parents(nodes), child_begin(nodes + 1), children(nodes);
+            std::vector<binary_format::span> node_names(nodes), edge_names(nodes);
+            for (size_t node = 0; node < nodes; ++node)
+            {
+                parents[node] = tree_->parent(node);
+                node_names[node] = intern_(tree_->name(node));
+                edge_names[node] = intern_(tree_->edge_name(node));
+
+                auto kids = tree_->children(node);
+                child_begin[node + 1] = child_begin[node] + kids.size();
+                for (size_t i = 0; i < kids.size(); ++i) { children[child_begin[node] + i] = kids.begin()[i]; }
+            }
+
+            auto pool = symbols_.pool();
+            binary_format::layout at(token_types_.size(), nodes, pool.size());
+
+            binary_format::header h{};
+            std::memcpy(h.magic, binary_format::magic, sizeof(h.magic));
+            h.version = binary_format::version;
+            h.byte_order = binary_format::byte_order_mark;
+            h.token_count = token_types_.size();
+            h.node_count = nodes;
+            h.root = tree_ ? tree_->root() : tree::npos;
+            h.pool_size = pool.size();
+            h.size = at.size;
+
+            std::string image(at.size, '\0');
+            put_(image, 0, &h, 1);
+            put_(image, at.token_names, token_names_.data(), token_names_.size());
+            put_(image, at.parents, parents.data(), parents.size());
+            put_(image, at.child_begin, child_begin.data(), child_begin.size());
+            put_(image, at.children, children.data(), children.size());
+            put_(image, at.node_names, node_names.data(), node_names.size());
+            put_(image, at.edge_names, edge_names.data(), edge_names.size());
+            put_(image, at.token_types, token_types_.data(), token_types_.size());
+            put_(image, at.pool, pool.data(), pool.size());
+            return image;
+        }
+    };
+
+    // Reads a binary image in place: nothing is copied or converted, so the
+    // bytes (e.g. a mapped_file's view) must outlive the binary_image and must
+    // start on an 8-byte boundary. Only the header is checked; names whose
+    // spans fall outside the pool come back cut short or empty, but a corrupt
+    // parent, child or token type is used as it is, so check bytes that did
+    // not come from this process with well_formed() before reading the tree.
+    class binary_image
+    {
+        std::string_view bytes_;
+        const binary_format::header* header_ = nullptr;
+        const binary_format::span* token_names_ = nullptr;
+        const uint64_t* parents_ = nullptr;
+        const uint64_t* child_begin_ = nullptr;
+        const uint64_t* children_ = nullptr;
+        const binary_format::span* node_names_ = nullptr;
+        const binary_format::span* edge_names_ = nullptr;
+        const uint8_t* token_types_ = nullptr;
+        std::string_view pool_;
+
+        template<class T>
+        const T* at_(uint64_t offset) const
+        {
+            return reinterpret_cast<const T*>(bytes_.data() + offset);
+        }
+
+        std::string_view name_(const binary_format::span& s) const
+        {
+            if (s.offset > pool_.size()) { return std::string_view(); }
+            return pool_.substr(static_cast<size_t>(s.offset), static_cast<size_t>(s.length));
+        }
+
+    public:
+        class node_range
+        {
+            const uint64_t* begin_;
+            const uint64_t* end_;
+
+        public:
+            node_range(const uint64_t* begin, const uint64_t* end) : begin_(begin), end_(end) {}
+
+            const uint64_t* begin() const { return begin_; }
+            const uint64_t* end() const { return end_; }
+            size_t size() const { return end_ - begin_; }
+            bool empty() const { return begin_ == end_; }
+        };
+
+        explicit binary_image(std::string_view bytes)
+            : bytes_(bytes)
+        {
+            if (bytes.size() < sizeof(binary_format::header) ||
+                reinterpret_cast<uintptr_t>(bytes.data()) % alignof(binary_format::header) != 0)
+            {
+                return;
+            }
+
+            auto h = at_<binary_format::header>(0);
+            if (std::memcmp(h->magic, binary_format::magic, sizeof(h->magic)) != 0 ||
+                h->version != binary_format::version ||
+                h->byte_order != binary_format::byte_order_mark ||
+                h->token_count > bytes.size() || h->node_count > bytes.size() || h->pool_size > bytes.size())
+            {
+                return;
+            }
+
+            binary_format::layout at(h->token_count, h->node_count, h->pool_size);
+            if (at.size != h->size || at.size > bytes.size()) { return; }
+
+            header_ = h;
+            token_names_ = at_<binary_format::span>(at.token_names);
+            parents_ = at_<uint64_t>(at.parents);
+            child_begin_ = at_<uint64_t>(at.child_begin);
+            children_ = at_<uint64_t>(at.children);
+            node_names_ = at_<binary_format::span>(at.node_names);
+            edge_names_ = at_<binary_format::span>(at.edge_names);
+            token_types_ = at_<uint8_t>(at.token_types);
+            pool_ = bytes.substr(static_cast<size_t>(at.pool), static_cast<size_t>(h->pool_size));
+        }
+
+        // false if the bytes are not a version 1 image in this machine's byte
+        // order; nothing else is meaningful then
+        bool valid() const
+        {
+            return header_ != nullptr;
+        }
+
+        // true if valid() and every token type is a toktype, every parent is
+        // a node or npos, and every child range lies in the children array
+        // and holds only nodes; O(tokens + nodes)
+        bool well_formed() const
+        {
+            if (!valid()) { return false; }
+
+            uint64_t nodes = header_->node_count;
+            if (nodes == 0 ? header_->root != tree::npos : header_->root >= nodes) { return false; }
+
+            for (uint64_t i = 0; i < header_->token_count; ++i)
+            {
+                if (token_types_[i] > token::vertical_edge_part) { return false; }
+            }
+
+            if (child_begin_[0] != 0) { return false; }
+            for (uint64_t node = 0; node < nodes; ++node)
+            {
+                if (parents_[node] >= nodes && parents_[node] != tree::npos) { return false; }
+                if (child_begin_[node + 1] < child_begin_[node] || child_begin_[node + 1] > nodes) { return false; }
+                if (children_[node] >= nodes) { return false; }
+            }
+            return true;
+        }
+
+        size_t token_count() const
+        {
+            return static_cast<size_t>(header_->token_count);
+        }
+
+        token::toktype type(size_t i) const
+        {
+            return static_cast<token::toktype>(token_types_[i]);
+        }
+
+        std::string_view name(size_t i) const
+        {
+            return name_(token_names_[i]);
+        }
+
+        token to_token(size_t i) const
+        {
+            return token(type(i), std::string(name(i)));
+        }
+
+        std::vector<token> tokens() const
+        {
+            std::vector<token> tokens;
+            tokens.reserve(token_count());
+            for (size_t i = 0; i < token_count(); ++i) { tokens.push_back(to_token(i)); }
+            return tokens;
+        }
+
+        // the tree, if one was written; the same accessors as tree
+        size_t size() const
+        {
+            return static_cast<size_t>(header_->node_count);
+        }
+
+        bool empty() const
+        {
+            return header_->node_count == 0;
+        }
+
+        size_t root() const
+        {
+            return static_cast<size_t>(header_->root);
+        }
+
+        size_t parent(size_t node) const
+        {
+            return static_cast<size_t>(parents_[node]);
+        }
+
+        node_range children(size_t node) const
+        {
+            return node_range(children_ + child_begin_[node], children_ + child_begin_[node + 1]);
+        }
+
+        std::string_view node_name(size_t node) const
+        {
+            return name_(node_names_[node]);
+        }
+
+        std::string_view edge_name(size_t node) const
+        {
+            return name_(edge_names_[node]);
+        }
+    };
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+    inline void save_binary(const std::string& path, std::string_view image)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        out.close();
+        if (!out) { throw std::system_error(std::make_error_code(std::errc::io_error), path); }
+    }
+#endif
+}
+
+#endif // ASCII_TREE_BINARY_H
@@ -0,0 +1,38 @@
+#if !defined(ASCII_TREE_BINARY_FILE_H)
+#define ASCII_TREE_BINARY_FILE_H
+
+#include <stdexcept>
+#include <string>
+#include "binary.hpp"
+#include "mapped_file.hpp"
+
+namespace ascii_tree
+{
+    struct binary_format_error : std::runtime_error
+    {
+        explicit binary_format_error(const std::string& what) : std::runtime_error(what) {}
+    };
+
+    // maps a saved image into memory; loading costs one mmap, a header check
+    // and a well_formed() pass over the tokens and nodes
+    class binary_file
+    {
+        mapped_file file_;
+        binary_image image_;
+
+    public:
+        explicit binary_file(const std::string& path)
+            : file_(path), image_(file_.view())
+        {
+            if (!image_.valid()) { throw binary_format_error(path + ": not a version 1 ascii_tree binary image"); }
+            if (!image_.well_formed()) { throw binary_format_error(path + ": corrupt ascii_tree binary image"); }
+        }
+
+        const binary_image& image() const
+        {
+            return image_;
+        }
+    };
+}
+
+#endif // ASCII_TREE_BINARY_FILE_H
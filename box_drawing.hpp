@@ -0,0 +1,96 @@
+#if !defined(ASCII_TREE_BOX_DRAWING_H)
+#define ASCII_TREE_BOX_DRAWING_H
+
+#include <string>
+#include <string_view>
+#include "scan.hpp"
+
+// Diagrams drawn with Unicode box-drawing chars, in UTF-8, are read as if
+// they were drawn in ASCII:
+//
+//     U+2502 (vertical) and U+251C (vertical and right)  as  '|'
+//     U+2514 (up and right)                               as  '\'
+//     U+2500 (horizontal)                                 as  '-'
+//
+// Each of these is three bytes but takes one column, so it becomes one char,
+// and offsets and columns into the result count it once. Finding out that a
+// text is pure ASCII reads it 16 or 32 chars at a time and copies nothing.
+//
+// The grammar reads its input as it is; ask for this with
+// grammar::from_box_drawing(). stream_tokenizer and incremental_tokenizer
+// turn each chunk or line into ASCII as they read it.
+//
+// Only the shapes the ASCII grammar already has are read. A branch drawn the
+// way the tree command draws it, e.g. U+251C U+2500 U+2500 [a], becomes
+// "|--[a]", which is rejected: a horizontal edge needs an edge name.
+
+namespace ascii_tree
+{
+    inline bool is_ascii(std::string_view text)
+    {
+        const char* end = text.data() + text.size();
+        return scan::skip_ascii(text.data(), end) == end;
+    }
+
+    // the ASCII char that the box-drawing char at it stands for, or 0 if
+    // there is none there
+    inline char box_drawing_char_(const char* it, const char* end)
+    {
+        if (end - it < 3 || it[0] != '\xE2' || it[1] != '\x94') { return 0; }
+        switch (it[2])
+        {
+        case '\x82': case '\x9C': return '|';
+        case '\x94': return '\\';
+        case '\x80': return '-';
+        default: return 0;
+        }
+    }
+
+    // text with every box-drawing char above replaced by its ASCII char; any
+    // other byte, ASCII or not, is copied as it is
+    inline std::string ascii_from_box_drawing(std::string_view text)
+    {
+        std::string ascii;
+        ascii.reserve(text.size());
+
+        const char* it = text.data();
+        const char* end = it + text.size();
+        while (it != end)
+        {
+            const char* run_end = scan::skip_ascii(it, end);
+            ascii.append(it, run_end);
+            it = run_end;
+            if (it == end) { break; }
+
+            if (char replacement = box_drawing_char_(it, end))
+            {
+                ascii += replacement;
+                it += 3;
+            }
+            else
+            {
+                ascii += *it++;
+            }
+        }
+
+        return ascii;
+    }
+
+    // the number of bytes at the end of text that start a UTF-8 sequence
+    // without finishing it, e.g. because a read split the sequence in two
+    inline size_t incomplete_utf8_suffix(std::string_view text)
+    {
+        for (size_t i = 1; i <= 3 && i <= text.size(); ++i)
+        {
+            auto byte = static_cast<unsigned char>(text[text.size() - i]);
+            if ((byte & 0xC0) == 0x80) { continue; } // a continuation byte
+            if (byte < 0xC0) { return 0; }
+
+            size_t length = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : 2;
+            return length > i ? i : 0;
+        }
+        return 0;
+    }
+}
+
+#endif // ASCII_TREE_BOX_DRAWING_H
@@ -0,0 +1,304 @@
+#if !defined(ASCII_TREE_DFA_LEXER_H)
+#define ASCII_TREE_DFA_LEXER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "grammar.hpp"
+#include "parser.hpp"
+#include "scan.hpp"
+
+#if 0
+
+THE TOKEN GRAMMAR AS A STATE MACHINE
+====================================
+
+The rules in grammar.hpp, with the spaces that the parser ignores between
+terminals written in, recognize each token from its first char onwards
+without ever needing to look back:
+
+    start              ' ' -> start
+                       '[' -> square_open
+                       '-' -> horizontal_dashes
+                       '(' -> edge_name_open
+                       '/' '|' backslash -> accept the edge part
+    square_open        ' ' -> square_open
+                       '*' -> root_star
+                       name-char -> node_name
+    root_star          ' ' -> root_star
+                       ']' -> accept root-node
+    node_name          name-char ' ' -> node_name
+                       ']' -> accept named-node
+    horizontal_dashes  '-' ' ' -> horizontal_dashes
+                       '(' -> horizontal_open
+    horizontal_open    ' ' -> horizontal_open
+                       name-char -> horizontal_name
+    horizontal_name    name-char ' ' -> horizontal_name
+                       ')' -> horizontal_close
+    horizontal_close   ' ' -> horizontal_close
+                       '-' -> horizontal_tail
+    horizontal_tail    '-' ' ' -> horizontal_tail
+                       anything else, or the end -> accept horizontal-edge,
+                       which ends before that char
+    edge_name_open     ' ' -> edge_name_open
+                       name-char -> edge_name_chars
+    edge_name_chars    name-char ' ' -> edge_name_chars
+                       ')' -> accept edge-name
+
+Every other (state, char) pair is an error at that char, and the end of the
+input in any state but start and horizontal_tail is an error at the end. A
+name runs from its first to its last name-char, so spaces inside it are kept
+and spaces after it are not.
+
+#endif
+
+namespace ascii_tree
+{
+    // the transition table for the machine above, built at compile time
+    struct dfa_table
+    {
+        enum state : uint8_t
+        {
+            start, square_open, root_star, node_name, horizontal_dashes, horizontal_open, horizontal_name,
+            horizontal_close, horizontal_tail, edge_name_open, edge_name_chars,
+            live_states,
+
+            // reaching one of these ends the token, including the char that led here
+            accept_root_node = live_states, accept_named_node, accept_edge_name,
+            accept_ascending_edge_part, accept_descending_edge_part, accept_vertical_edge_part,
+            // ends the token before the char that led here
+            accept_horizontal_edge,
+            reject
+        };
+
+        static constexpr size_t terminal_count = space + 1;
+        typedef std::array<std::array<state, terminal_count>, live_states> table_type;
+
+        static constexpr void on_(table_type& table, state from, terminal term, state to)
+        {
+            table[from][term] = to;
+        }
+
+        static constexpr table_type make()
+        {
+            table_type table{};
+            for (auto& row : table)
+            {
+                for (auto& to : row) { to = reject; }
+            }
+
+            on_(table, start, space, start);
+            on_(table, start, open_square_brace, square_open);
+            on_(table, start, dash, horizontal_dashes);
+            on_(table, start, open_paren, edge_name_open);
+            on_(table, start, slash, accept_ascending_edge_part);
+            on_(table, start, backslash, accept_descending_edge_part);
+            on_(table, start, pipe, accept_vertical_edge_part);
+
+            on_(table, square_open, space, square_open);
+            on_(table, square_open, asterisk, root_star);
+            on_(table, square_open, name_char, node_name);
+
+            on_(table, root_star, space, root_star);
+            on_(table, root_star, close_square_brace, accept_root_node);
+
+            on_(table, node_name, name_char, node_name);
+            on_(table, node_name, space, node_name);
+            on_(table, node_name, close_square_brace, accept_named_node);
+
+            on_(table, horizontal_dashes, dash, horizontal_dashes);
+            on_(table, horizontal_dashes, space, horizontal_dashes);
+            on_(table, horizontal_dashes, open_paren, horizontal_open);
+
+            on_(table, horizontal_open, space, horizontal_open);
+            on_(table, horizontal_open, name_char, horizontal_name);
+
+            on_(table, horizontal_name, name_char, horizontal_name);
+            on_(table, horizontal_name, space, horizontal_name);
+            on_(table, horizontal_name, close_paren, horizontal_close);
+
+            on_(table, horizontal_close, space, horizontal_close);
+            on_(table, horizontal_close, dash, horizontal_tail);
+
+            for (auto& to : table[horizontal_tail])
+            {
+                to = accept_horizontal_edge;
+            }
+            on_(table, horizontal_tail, dash, horizontal_tail);
+            on_(table, horizontal_tail, space, horizontal_tail);
+
+            on_(table, edge_name_open, space, edge_name_open);
+            on_(table, edge_name_open, name_char, edge_name_chars);
+
+            on_(table, edge_name_chars, name_char, edge_name_chars);
+            on_(table, edge_name_chars, space, edge_name_chars);
+            on_(table, edge_name_chars, close_paren, accept_edge_name);
+
+            return table;
+        }
+
+        static const table_type table;
+
+        static constexpr token::toktype type_of(state accept)
+        {
+            constexpr token::toktype types[] = {
+                token::root_node, token::named_node, token::edge_name, token::ascending_edge_part,
+                token::descending_edge_part, token::vertical_edge_part, token::horizontal_edge
+            };
+            return types[accept - live_states];
+        }
+
+        static constexpr bool in_name(state s)
+        {
+            return s == node_name || s == horizontal_name || s == edge_name_chars;
+        }
+    };
+
+    inline constexpr dfa_table::table_type dfa_table::table = dfa_table::make();
+
+    // Produces the same tokens, offsets and errors as grammar, but reads each
+    // char exactly once: one table lookup per char picks the next state, with
+    // no lookahead copy, no rewinding and no re-parse of a token's first chars.
+    // Borrows the input, which must outlive the lexer, and reads it as ASCII;
+    // give it ascii_from_box_drawing(text) for a diagram in box-drawing chars.
+    class dfa_lexer
+    {
+        std::string_view source_;
+        size_t pos_ = 0;
+        size_t error_ = std::string_view::npos;
+
+    public:
+        explicit dfa_lexer(std::string_view source)
+            : source_(source)
+        {}
+
+        std::string_view source() const
+        {
+            return source_;
+        }
+
+        size_t offset() const
+        {
+            return pos_;
+        }
+
+        bool failed() const
+        {
+            return error_ != std::string_view::npos;
+        }
+
+        // only meaningful when failed()
+        parse_error error() const
+        {
+            return make_parse_error(source_, error_);
+        }
+
+        std::string_view name(const token_ref& ref) const
+        {
+            return source_.substr(ref.offset, ref.length);
+        }
+
+        token to_token(const token_ref& ref) const
+        {
+            return token(ref.type, std::string(name(ref)));
+        }
+
+        // reads the next token into ref, or returns false at the end of the
+        // input or at the first error
+        bool next(token_ref& ref)
+        {
+            if (failed()) { return false; }
+
+            auto state = dfa_table::start;
+            size_t token_begin = pos_, name_begin = 0, name_end = 0;
+            size_t i = pos_, size = source_.size();
+
+            for (; i < size; ++i)
+            {
+                auto term = terminal_traits::to_terminal(source_[i]);
+                auto next = dfa_table::table[state][term];
+
+                if (next < dfa_table::live_states)
+                {
+                    if (term == space)
+                    {
+                        // every live state loops on spaces, so the whole run is skipped at once
+                        i = scan::skip_char(source_.data() + i, source_.data() + size, ' ') - source_.data() - 1;
+                    }
+                    if (state == dfa_table::start) { token_begin = next == dfa_table::start ? i + 1 : i; }
+                    if (term == name_char)
+                    {
+                        if (!dfa_table::in_name(state)) { name_begin = i; }
+                        name_end = i + 1;
+                    }
+                    state = next;
+                    continue;
+                }
+
+                if (next == dfa_table::reject)
+                {
+                    pos_ = i;
+                    error_ = i;
+                    return false;
+                }
+
+                if (state == dfa_table::start) { token_begin = i; }
+                pos_ = next == dfa_table::accept_horizontal_edge ? i : i + 1;
+                ref = dfa_table::in_name(state) || next == dfa_table::accept_horizontal_edge
+                    ? token_ref{ dfa_table::type_of(next), name_begin, name_end - name_begin }
+                    : token_ref{ dfa_table::type_of(next), token_begin, 0 };
+                return true;
+            }
+
+            pos_ = size;
+            if (state == dfa_table::start) { return false; }
+            if (state != dfa_table::horizontal_tail)
+            {
+                error_ = size;
+                return false;
+            }
+
+            ref = token_ref{ token::horizontal_edge, name_begin, name_end - name_begin };
+            return true;
+        }
+
+        parse_result<std::vector<token_ref>> try_token_refs()
+        {
+            std::vector<token_ref> refs;
+            token_ref ref{};
+            while (next(ref)) { refs.push_back(ref); }
+            if (failed()) { return parse_result<std::vector<token_ref>>(error()); }
+            return parse_result<std::vector<token_ref>>(std::move(refs));
+        }
+
+        parse_result<std::vector<token>> try_tokens()
+        {
+            std::vector<token> tokens;
+            token_ref ref{};
+            while (next(ref)) { tokens.emplace_back(to_token(ref)); }
+            if (failed()) { return parse_result<std::vector<token>>(error()); }
+            return parse_result<std::vector<token>>(std::move(tokens));
+        }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        std::vector<token_ref> token_refs()
+        {
+            auto result = try_token_refs();
+            if (!result) { throw parse_exception(std::string(source_), result.error().pos); }
+            return std::move(result.value());
+        }
+
+        std::vector<token> tokens()
+        {
+            auto result = try_tokens();
+            if (!result) { throw parse_exception(std::string(source_), result.error().pos); }
+            return std::move(result.value());
+        }
+#endif
+    };
+}
+
+#endif // ASCII_TREE_DFA_LEXER_H
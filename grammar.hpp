@@ -1,12 +1,22 @@
 #if !defined(ASCII_TREE_GRAMMAR_H)
 #define ASCII_TREE_GRAMMAR_H
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <utility>
-#include <cctype>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <vector>
+#include "box_drawing.hpp"
+#include "line_index.hpp"
 #include "parser.hpp"
+#include "scan.hpp"
+#include "symbol_table.hpp"
 
 #if 0
 
@@ -76,24 +86,42 @@ namespace ascii_tree
     inline token descending_edge_part() { return token(token::descending_edge_part, ""); }
     inline token vertical_edge_part() { return token(token::vertical_edge_part, ""); }
 
+    // a token whose name is an (offset, length) span into the grammar's input
+    // rather than a std::string of its own, so producing one never allocates
+    struct token_ref
+    {
+        token::toktype type;
+        size_t offset;
+        size_t length;
+    };
+
+    inline bool operator==(const token_ref& lhs, const token_ref& rhs)
+    {
+        return lhs.type == rhs.type
+            && lhs.offset == rhs.offset
+            && lhs.length == rhs.length;
+    }
+
     enum terminal
     {
         none, open_square_brace, close_square_brace, asterisk, dash,
         open_paren, close_paren, name_char, slash, backslash, pipe, space
     };
 
-    struct terminal_traits
+    struct terminal_traits : table_terminal_traits<terminal_traits>
     {
         typedef terminal type;
 
         static const type ignore_me = space;
 
-        static terminal to_terminal(char ch)
+        // locale-independent; to_terminal() looks the result up in a table
+        static constexpr terminal classify(char ch)
         {
             if (ch == '[') return open_square_brace;
             else if (ch == '*') return asterisk;
             else if (ch == ']') return close_square_brace;
-            else if (isalnum(ch) || ch == '_') return name_char;
+            else if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
+                (ch >= '0' && ch <= '9') || ch == '_') return name_char;
             else if (ch == '-') return dash;
             else if (ch == '(') return open_paren;
             else if (ch == ')') return close_paren;
@@ -103,126 +131,821 @@ namespace ascii_tree
             else if (ch == ' ') return space;
             return none;
         }
+
+        static const char* scan(terminal term, const char* first, const char* last)
+        {
+            switch (term)
+            {
+            case space:
+                return scan::skip_char(first, last, ' ');
+            case dash:
+                return scan::skip_either_char(first, last, '-', ' ');
+            case name_char:
+                return scan::skip_name_chars_or(first, last, ' ');
+            default:
+                while (first != last && (to_terminal(*first) == term || to_terminal(*first) == ignore_me)) { ++first; }
+                return first;
+            }
+        }
+    };
+
+    // a token_ref (whose name span is an offset into the whole input) plus
+    // where the token sits in a multi-line diagram
+    struct located_token
+    {
+        token_ref ref;
+        size_t row;
+        size_t column;
+        size_t length;
+    };
+
+    inline bool operator==(const located_token& lhs, const located_token& rhs)
+    {
+        return lhs.ref == rhs.ref
+            && lhs.row == rhs.row
+            && lhs.column == rhs.column
+            && lhs.length == rhs.length;
+    }
+
+    // a token whose name is an id in a symbol_table, so tokens compare and
+    // hash in constant time whatever their names
+    struct interned_token
+    {
+        token::toktype type;
+        symbol_id name;
     };
 
-    class grammar
+    inline bool operator==(const interned_token& lhs, const interned_token& rhs)
+    {
+        return lhs.type == rhs.type
+            && lhs.name == rhs.name;
+    }
+
+    inline token to_token(const interned_token& tok, const symbol_table& symbols)
     {
-        parser<terminal_traits> p_;
+        return token(tok.type, std::string(symbols.name(tok.name)));
+    }
 
-        std::string expect_name_chars_()
+    struct interned_token_hash
+    {
+        size_t operator()(const interned_token& tok) const
         {
-            auto begin = p_.expect(name_char);
-            while (p_.accept(name_char)) {}
-            p_.unignore(); // strip trailing spaces
-            return p_.substring(begin);
+            return (static_cast<size_t>(tok.name) << 3) ^ static_cast<size_t>(tok.type);
         }
+    };
+
+    enum class parse_errc
+    {
+        unexpected_char = 1,
+        unexpected_end
+    };
+
+    // what went wrong, without a copy of the input
+    struct parse_error
+    {
+        parse_errc code;
+        size_t pos;
+        terminal found; // the terminal at pos, or none at the end of the input
+    };
+
+    inline parse_error make_parse_error(std::string_view source, size_t pos)
+    {
+        return pos == source.size()
+            ? parse_error{ parse_errc::unexpected_end, pos, none }
+            : parse_error{ parse_errc::unexpected_char, pos, terminal_traits::to_terminal(source[pos]) };
+    }
+
+    // the number of tokens in source, if it is valid: every token has exactly
+    // one '[', '(', '/', '\' or '|', and names have none. Invalid input may
+    // count high. One pass, 16 or 32 chars at a time (see scan.hpp).
+    inline size_t estimate_token_count(std::string_view source)
+    {
+        return scan::count_token_starts(source.data(), source.data() + source.size());
+    }
+
+    // either a value or the parse_error that prevented it
+    template<class T>
+    class parse_result
+    {
+        T value_;
+        parse_error error_;
+        bool ok_;
 
     public:
-        explicit grammar(const std::string& s)
-            : p_(s)
-        {}
+        parse_result(T&& value) : value_(std::move(value)), error_{}, ok_(true) {}
+        parse_result(const parse_error& error) : value_(), error_(error), ok_(false) {}
+
+        explicit operator bool() const { return ok_; }
+        bool has_value() const { return ok_; }
+
+        // only meaningful when has_value()
+        T& value() { return value_; }
+        const T& value() const { return value_; }
+
+        // only meaningful when !has_value()
+        const parse_error& error() const { return error_; }
+    };
+
+    // everything a recovering parse found: the tokens it could read and an
+    // error for each stretch of input it had to skip
+    template<class Token>
+    struct recovered
+    {
+        std::vector<Token> tokens;
+        std::vector<parse_error> errors;
+    };
+
+    // the stretches of work an instrumentation policy can time (see parser)
+    enum class parse_phase
+    {
+        tokenize,   // the tokens() family, next() and lazy_tokens()
+        locate,     // the located_tokens() family
+        recover     // recover_tokens() and recover_located_tokens()
+    };
+
+    // Tokenizes an ASCII tree diagram. Instrumentation is told, besides what
+    // the parser tells it, the type of each token read and when each
+    // parse_phase begins and ends; grammar, which tells no_instrumentation,
+    // is what nearly everyone wants.
+    template<class Instrumentation>
+    class basic_grammar
+    {
+        static constexpr size_t no_error = static_cast<size_t>(-1);
+
+        parser<terminal_traits, Instrumentation> p_;
+
+        std::pair<size_t, size_t> expect_name_chars_()
+        {
+            auto begin = p_.check(name_char).offset();
+            p_.accept_all(name_char);
+            p_.unignore(); // strip trailing spaces
+            return std::make_pair(begin, p_.offset() - begin);
+        }
 
-        token root_node()
+        token_ref unnamed_ref_(token::toktype type, const position& start)
         {
-            p_.expect(open_square_brace);
-            p_.expect(asterisk);
-            p_.expect(close_square_brace);
-            return ascii_tree::root_node();
+            return token_ref{ type, start.offset(), 0 };
         }
 
-        token named_node()
+        token_ref named_ref_(token::toktype type, std::pair<size_t, size_t> name)
         {
-            p_.expect(open_square_brace);
+            return token_ref{ type, name.first, name.second };
+        }
+
+        token_ref root_node_ref_()
+        {
+            auto start = p_.check(open_square_brace);
+            p_.check(asterisk);
+            p_.check(close_square_brace);
+            return unnamed_ref_(token::root_node, start);
+        }
+
+        token_ref named_node_ref_()
+        {
+            p_.check(open_square_brace);
             auto name = expect_name_chars_();
-            p_.expect(close_square_brace);
-            return ascii_tree::named_node(std::move(name));
+            p_.check(close_square_brace);
+            return named_ref_(token::named_node, name);
         }
 
-        token edge_name()
+        token_ref edge_name_ref_()
         {
-            p_.expect(open_paren);
+            p_.check(open_paren);
             auto name = expect_name_chars_();
-            p_.expect(close_paren);
-            return ascii_tree::edge_name(std::move(name));
+            p_.check(close_paren);
+            return named_ref_(token::edge_name, name);
         }
 
-        token ascending_edge_part()
+        token_ref ascending_edge_part_ref_()
         {
-            p_.expect(slash);
-            return ascii_tree::ascending_edge_part();
+            return unnamed_ref_(token::ascending_edge_part, p_.check(slash));
         }
 
-        token descending_edge_part()
+        token_ref descending_edge_part_ref_()
         {
-            p_.expect(backslash);
-            return ascii_tree::descending_edge_part();
+            return unnamed_ref_(token::descending_edge_part, p_.check(backslash));
         }
 
-        token vertical_edge_part()
+        token_ref vertical_edge_part_ref_()
         {
-            p_.expect(pipe);
-            return ascii_tree::vertical_edge_part();
+            return unnamed_ref_(token::vertical_edge_part, p_.check(pipe));
         }
 
-        token horizontal_edge()
+        token_ref horizontal_edge_ref_()
         {
-            p_.expect(dash);
-            while (p_.accept(dash)) {}
-            p_.expect(open_paren);
+            p_.check(dash);
+            p_.accept_all(dash);
+            p_.check(open_paren);
             auto name = expect_name_chars_();
-            p_.expect(close_paren);
-            p_.expect(dash);
-            while (p_.accept(dash)) {}
-            return ascii_tree::horizontal_edge(std::move(name));
+            p_.check(close_paren);
+            p_.check(dash);
+            p_.accept_all(dash);
+            return named_ref_(token::horizontal_edge, name);
         }
 
-        std::vector<token> tokens()
+        // accept() that leaves p_ where it was
+        bool peek_(terminal term)
         {
-            std::vector<token> tokens;
-            while (p_.ignore(), !p_.at_end())
+            auto start = p_.current_position();
+            bool found = p_.accept(term);
+            p_.rewind(start);
+            return found;
+        }
+
+        // reads the next token into ref, or returns false at the end of the
+        // input or at the first error
+        bool next_ref_(token_ref& ref)
+        {
+            p_.ignore();
+            if (p_.at_end() || p_.failed()) { return false; }
+
+            // look ahead by rewinding to a plain offset rather than copying p_
+            auto start = p_.current_position();
+
+            if (p_.accept(open_square_brace))
             {
-                auto peek = p_;
+                bool root = p_.accept(asterisk);
+                p_.rewind(start);
+                ref = root ? root_node_ref_() : named_node_ref_();
+            }
+            else if (peek_(dash))
+            {
+                ref = horizontal_edge_ref_();
+            }
+            else if (peek_(backslash))
+            {
+                ref = descending_edge_part_ref_();
+            }
+            else if (peek_(pipe))
+            {
+                ref = vertical_edge_part_ref_();
+            }
+            else if (peek_(slash))
+            {
+                ref = ascending_edge_part_ref_();
+            }
+            else if (peek_(open_paren))
+            {
+                ref = edge_name_ref_();
+            }
+            else
+            {
+                p_.fail();
+            }
+
+            if (p_.failed()) { return false; }
+            p_.instrumentation().tokenized(ref.type);
+            return true;
+        }
+
+        template<class Emit>
+        void tokenize_(Emit emit)
+        {
+            p_.instrumentation().begin(parse_phase::tokenize);
+            token_ref ref{};
+            while (next_ref_(ref))
+            {
+                emit(ref);
+            }
+            p_.instrumentation().end(parse_phase::tokenize);
+        }
+
+        parse_error error_at_(size_t pos)
+        {
+            return make_parse_error(p_.source(), pos);
+        }
+
+        // like tokenize_, but after an error it records it and resumes at the
+        // next char that can start a token; emit(ref, start) gets the offset
+        // at which each token starts
+        template<class Emit>
+        void recover_(Emit emit, std::vector<parse_error>& errors)
+        {
+            auto source = p_.source();
+            token_ref ref{};
 
-                if (peek.accept(open_square_brace))
+            for (;;)
+            {
+                p_.ignore();
+                size_t start = p_.offset();
+                if (next_ref_(ref))
                 {
-                    if (peek.accept(asterisk))
-                    {
-                        tokens.emplace_back(root_node());
-                    }
-                    else
-                    {
-                        tokens.emplace_back(named_node());
-                    }
+                    emit(ref, start);
+                    continue;
                 }
-                else if (peek.accept(dash))
+                if (!p_.failed()) { return; }
+
+                size_t pos = p_.error_offset();
+                errors.push_back(error_at_(pos));
+
+                // a token that broke part way through may have run into the
+                // start of the next one, so look from the error itself
+                size_t resume = pos == source.size() ? std::string_view::npos
+                    : source.find_first_of("[(-|/\\", pos > start ? pos : pos + 1);
+                if (resume == std::string_view::npos) { return; }
+                p_.recover_at(resume);
+            }
+        }
+
+        template<class Vector>
+        void locate_tokens_(Vector& located, std::pmr::memory_resource* resource)
+        {
+            p_.instrumentation().begin(parse_phase::locate);
+            line_index lines(p_.source(), resource);
+            size_t error = locate_rows_(located, lines, 0, lines.rows(), p_.instrumentation());
+            if (error != no_error) { p_.fail_at(error); }
+            p_.instrumentation().end(parse_phase::locate);
+        }
+
+        // returns the offset of the first error, or no_error; safe to call
+        // from several threads at once because it leaves p_ alone and only
+        // tells stats about the work it does
+        template<class Vector>
+        size_t locate_rows_(Vector& located, const line_index& lines, size_t first_row, size_t last_row,
+            Instrumentation& stats)
+        {
+            for (size_t row = first_row; row < last_row; ++row)
+            {
+                auto line = lines.line(row);
+                auto line_offset = lines.line_begin(row);
+                basic_grammar g(line);
+                size_t prev_end = 0;
+
+                token_ref ref{};
+                while (g.next_ref_(ref))
                 {
-                    tokens.emplace_back(horizontal_edge());
+                    // the parser skips spaces on both sides of a token, so
+                    // trim them to find the chars the token itself covers
+                    size_t begin = prev_end;
+                    while (line[begin] == ' ') { ++begin; }
+                    size_t end = prev_end = g.offset();
+                    while (end > begin && line[end - 1] == ' ') { --end; }
+
+                    ref.offset += line_offset;
+                    located.push_back(located_token{ ref, row, begin, end - begin });
                 }
-                else if (peek.accept(backslash))
+
+                stats.merge(g.p_.instrumentation());
+                if (g.failed()) { return line_offset + g.p_.error_offset(); }
+            }
+
+            return no_error;
+        }
+
+        void locate_tokens_parallel_(std::vector<located_token>& located, unsigned threads)
+        {
+            p_.instrumentation().begin(parse_phase::locate);
+            locate_chunks_(located, threads);
+            p_.instrumentation().end(parse_phase::locate);
+        }
+
+        void locate_chunks_(std::vector<located_token>& located, unsigned threads)
+        {
+            const size_t min_chunk_size = 64 * 1024; // smaller chunks cost more to start than they save
+
+            auto source = p_.source();
+            line_index lines(source);
+            size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, source.size() / min_chunk_size));
+            if (chunks == 1)
+            {
+                size_t error = locate_rows_(located, lines, 0, lines.rows(), p_.instrumentation());
+                if (error != no_error) { p_.fail_at(error); }
+                return;
+            }
+
+            std::vector<size_t> first_rows(chunks + 1, lines.rows());
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                first_rows[i] = lines.row_of(source.size() / chunks * i);
+            }
+
+            std::vector<std::vector<located_token>> results(chunks);
+            std::vector<size_t> errors(chunks, no_error);
+            std::vector<Instrumentation> stats(chunks);
+            std::vector<std::thread> workers;
+            workers.reserve(chunks);
+
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                workers.emplace_back([&, i]
                 {
-                    tokens.emplace_back(descending_edge_part());
+                    errors[i] = locate_rows_(results[i], lines, first_rows[i], first_rows[i + 1], stats[i]);
+                });
+            }
+
+            for (auto& worker : workers) { worker.join(); }
+            for (auto& chunk_stats : stats) { p_.instrumentation().merge(chunk_stats); }
+
+            size_t total = 0;
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                if (errors[i] != no_error)
+                {
+                    p_.fail_at(errors[i]);
+                    return;
                 }
-                else if (peek.accept(pipe))
+                total += results[i].size();
+            }
+
+            located.reserve(total);
+            for (auto& result : results)
+            {
+                located.insert(located.end(), result.begin(), result.end());
+            }
+        }
+
+        template<class T>
+        parse_result<T> result_(T&& value)
+        {
+            if (p_.failed()) { return parse_result<T>(error()); }
+            return parse_result<T>(std::move(value));
+        }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        template<class T>
+        T&& throw_if_failed_(T&& value)
+        {
+            if (p_.failed()) { p_.error(); }
+            return std::forward<T>(value);
+        }
+#endif
+
+    public:
+        explicit basic_grammar(const std::string& s)
+            : p_(s)
+        {}
+
+        explicit basic_grammar(std::string&& s)
+            : p_(std::move(s))
+        {}
+
+        explicit basic_grammar(const char* s)
+            : p_(s)
+        {}
+
+        // borrows the input; the chars must outlive the grammar and its tokens
+        explicit basic_grammar(std::string_view s)
+            : p_(s)
+        {}
+
+        // copies the input into memory from the resource (see parser)
+        basic_grammar(std::string_view s, std::pmr::memory_resource* resource)
+            : p_(s, resource)
+        {}
+
+        // borrows s and keeps owner, whatever holds s's chars, alive with the grammar
+        basic_grammar(std::shared_ptr<const void> owner, std::string_view s)
+            : p_(std::move(owner), s)
+        {}
+
+        // For a diagram drawn in box-drawing chars: tokenizes the copy that
+        // ascii_from_box_drawing() makes of s (see box_drawing.hpp), which the
+        // grammar owns. source(), and every offset, column and error, refer to
+        // that copy, in which each box-drawing char is one char. The other
+        // constructors read their input as it is.
+        static basic_grammar from_box_drawing(std::string_view s)
+        {
+            return basic_grammar(ascii_from_box_drawing(s));
+        }
+
+        std::string_view source()
+        {
+            return p_.source();
+        }
+
+        // what the policy has been told so far
+        Instrumentation& instrumentation()
+        {
+            return p_.instrumentation();
+        }
+
+        // the offset just past the last token read
+        size_t offset()
+        {
+            return p_.offset();
+        }
+
+        // whether tokenizing stopped at an error; see error()
+        bool failed()
+        {
+            return p_.failed();
+        }
+
+        // only meaningful when failed()
+        parse_error error()
+        {
+            return error_at_(p_.error_offset());
+        }
+
+        // see the free estimate_token_count(); costs one pass over the input
+        size_t estimate_token_count()
+        {
+            return ascii_tree::estimate_token_count(p_.source());
+        }
+
+        std::string_view name(const token_ref& ref)
+        {
+            return p_.source().substr(ref.offset, ref.length);
+        }
+
+        token to_token(const token_ref& ref)
+        {
+            return token(ref.type, std::string(name(ref)));
+        }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        token root_node() { return to_token(throw_if_failed_(root_node_ref_())); }
+        token named_node() { return to_token(throw_if_failed_(named_node_ref_())); }
+        token edge_name() { return to_token(throw_if_failed_(edge_name_ref_())); }
+        token ascending_edge_part() { return to_token(throw_if_failed_(ascending_edge_part_ref_())); }
+        token descending_edge_part() { return to_token(throw_if_failed_(descending_edge_part_ref_())); }
+        token vertical_edge_part() { return to_token(throw_if_failed_(vertical_edge_part_ref_())); }
+        token horizontal_edge() { return to_token(throw_if_failed_(horizontal_edge_ref_())); }
+#endif
+
+        // a single-pass range that reads each token only when the iterator is
+        // advanced; the grammar must outlive the range and its iterators.
+        // Advancing onto an invalid token throws, or without exceptions ends
+        // the range with failed() set.
+        class token_range
+        {
+            basic_grammar* g_;
+
+        public:
+            class iterator
+            {
+                basic_grammar* g_; // null once the input is exhausted
+                token_ref ref_;
+
+            public:
+                typedef std::input_iterator_tag iterator_category;
+                typedef token value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const token* pointer;
+                typedef token reference;
+
+                iterator() : g_(nullptr), ref_{} {}
+
+                explicit iterator(basic_grammar* g) : g_(g), ref_{}
                 {
-                    tokens.emplace_back(vertical_edge_part());
+                    ++*this;
                 }
-                else if (peek.accept(slash))
+
+                token operator*() const
                 {
-                    tokens.emplace_back(ascending_edge_part());
+                    return g_->to_token(ref_);
                 }
-                else if (peek.accept(open_paren))
+
+                const token_ref& ref() const
                 {
-                    tokens.emplace_back(edge_name());
+                    return ref_;
                 }
-                else
+
+                iterator& operator++()
+                {
+                    if (!g_->next(ref_))
+                    {
+#if defined(ASCII_TREE_EXCEPTIONS)
+                        if (g_->failed()) { g_->p_.error(); }
+#endif
+                        g_ = nullptr;
+                    }
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator prev = *this;
+                    ++*this;
+                    return prev;
+                }
+
+                friend bool operator==(const iterator& lhs, const iterator& rhs)
+                {
+                    return lhs.g_ == rhs.g_;
+                }
+
+                friend bool operator!=(const iterator& lhs, const iterator& rhs)
+                {
+                    return !(lhs == rhs);
+                }
+            };
+
+            explicit token_range(basic_grammar& g) : g_(&g) {}
+
+            iterator begin() { return iterator(g_); }
+            iterator end() { return iterator(); }
+        };
+
+        token_range lazy_tokens()
+        {
+            return token_range(*this);
+        }
+
+        // reads the next token into ref; returns false at the end of the input
+        // or, with failed() set, at an error. Never throws.
+        bool next(token_ref& ref)
+        {
+            p_.instrumentation().begin(parse_phase::tokenize);
+            bool found = next_ref_(ref);
+            p_.instrumentation().end(parse_phase::tokenize);
+            return found;
+        }
+
+        // the try_ functions never throw a parse_exception (nor copy the input
+        // into one); they return the first error as a parse_error instead
+
+        parse_result<std::vector<token>> try_tokens()
+        {
+            std::vector<token> tokens;
+            tokens.reserve(estimate_token_count());
+            tokenize_([&](const token_ref& ref) { tokens.emplace_back(to_token(ref)); });
+            return result_(std::move(tokens));
+        }
+
+        // writes each token to out and returns how many it wrote; tokens read
+        // before an error are written too
+        template<class OutputIt>
+        parse_result<size_t> try_tokens_into(OutputIt out)
+        {
+            size_t count = 0;
+            tokenize_([&](const token_ref& ref)
+            {
+                *out++ = to_token(ref);
+                ++count;
+            });
+            return result_(std::move(count));
+        }
+
+        // appends to a container with reserve() and push_back(), such as a
+        // std::vector kept across parses, after reserving room for every token
+        template<class Container>
+        parse_result<size_t> try_append_tokens(Container& tokens)
+        {
+            tokens.reserve(tokens.size() + estimate_token_count());
+            return try_tokens_into(std::back_inserter(tokens));
+        }
+
+        // tokens whose names are interned in symbols, which may be shared by
+        // many grammars so that equal names get equal ids across inputs
+        parse_result<std::vector<interned_token>> try_interned_tokens(symbol_table& symbols)
+        {
+            std::vector<interned_token> tokens;
+            tokenize_([&](const token_ref& ref) { tokens.push_back(interned_token{ ref.type, symbols.intern(name(ref)) }); });
+            return result_(std::move(tokens));
+        }
+
+        parse_result<std::vector<token_ref>> try_token_refs()
+        {
+            std::vector<token_ref> refs;
+            refs.reserve(estimate_token_count());
+            tokenize_([&](const token_ref& ref) { refs.push_back(ref); });
+            return result_(std::move(refs));
+        }
+
+        parse_result<std::vector<located_token>> try_located_tokens()
+        {
+            std::vector<located_token> located;
+            locate_tokens_(located, std::pmr::get_default_resource());
+            return result_(std::move(located));
+        }
+
+        parse_result<std::pmr::vector<located_token>> try_located_tokens(std::pmr::memory_resource* resource)
+        {
+            std::pmr::vector<located_token> located(resource);
+            locate_tokens_(located, resource);
+            return result_(std::move(located));
+        }
+
+        parse_result<std::vector<located_token>> try_located_tokens_parallel(unsigned threads = std::thread::hardware_concurrency())
+        {
+            std::vector<located_token> located;
+            locate_tokens_parallel_(located, threads);
+            return result_(std::move(located));
+        }
+
+        // reads every token it can in one pass and returns them with an error
+        // for each bad stretch of input, resuming after each error at the next
+        // '[', '(', '-', '|', '/' or '\'
+        recovered<token> recover_tokens()
+        {
+            p_.instrumentation().begin(parse_phase::recover);
+            recovered<token> result;
+            recover_([&](const token_ref& ref, size_t) { result.tokens.emplace_back(to_token(ref)); }, result.errors);
+            p_.instrumentation().end(parse_phase::recover);
+            return result;
+        }
+
+        // recover_tokens() for multi-line diagrams; each line recovers on its own
+        recovered<located_token> recover_located_tokens()
+        {
+            p_.instrumentation().begin(parse_phase::recover);
+            recovered<located_token> result;
+            line_index lines(p_.source());
+
+            for (size_t row = 0; row < lines.rows(); ++row)
+            {
+                auto line = lines.line(row);
+                auto line_offset = lines.line_begin(row);
+                basic_grammar g(line);
+                size_t first_error = result.errors.size();
+
+                g.recover_([&](token_ref ref, size_t begin)
                 {
-                    p_.error();
+                    size_t end = g.offset();
+                    while (end > begin && line[end - 1] == ' ') { --end; }
+
+                    ref.offset += line_offset;
+                    result.tokens.push_back(located_token{ ref, row, begin, end - begin });
+                }, result.errors);
+
+                for (size_t i = first_error; i < result.errors.size(); ++i)
+                {
+                    result.errors[i].pos += line_offset;
                 }
+                p_.instrumentation().merge(g.p_.instrumentation());
             }
 
+            p_.instrumentation().end(parse_phase::recover);
+            return result;
+        }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        std::vector<token> tokens()
+        {
+            return std::move(throw_if_failed_(try_tokens()).value());
+        }
+
+        // only the vector's storage comes from the resource; each name is a
+        // std::string, as in tokens()
+        std::pmr::vector<token> tokens(std::pmr::memory_resource* resource)
+        {
+            std::pmr::vector<token> tokens(resource);
+            append_tokens(tokens);
             return tokens;
         }
+
+        // returns out advanced past the tokens
+        template<class OutputIt>
+        OutputIt tokens_into(OutputIt out)
+        {
+            tokenize_([&](const token_ref& ref) { *out++ = to_token(ref); });
+            return throw_if_failed_(std::move(out));
+        }
+
+        // returns the number of tokens appended
+        template<class Container>
+        size_t append_tokens(Container& tokens)
+        {
+            return throw_if_failed_(try_append_tokens(tokens)).value();
+        }
+
+        // tokenizes each line of a multi-line diagram in turn, so every token is
+        // located by (row, column, length) in one pass; tokens come out ordered
+        // by row, then by column
+        std::vector<located_token> located_tokens()
+        {
+            return std::move(throw_if_failed_(try_located_tokens()).value());
+        }
+
+        std::pmr::vector<located_token> located_tokens(std::pmr::memory_resource* resource)
+        {
+            return std::move(throw_if_failed_(try_located_tokens(resource)).value());
+        }
+
+        // same as located_tokens(), but the rows are split into chunks of roughly
+        // equal size at line boundaries and each chunk is tokenized on its own
+        // thread; if several chunks fail, the error nearest the start is thrown
+        std::vector<located_token> located_tokens_parallel(unsigned threads = std::thread::hardware_concurrency())
+        {
+            return std::move(throw_if_failed_(try_located_tokens_parallel(threads)).value());
+        }
+
+        std::vector<interned_token> interned_tokens(symbol_table& symbols)
+        {
+            return std::move(throw_if_failed_(try_interned_tokens(symbols)).value());
+        }
+
+        // like tokens(), but every name is a span into the input, so the only
+        // allocations are the vector's own
+        std::vector<token_ref> token_refs()
+        {
+            return std::move(throw_if_failed_(try_token_refs()).value());
+        }
+
+        std::pmr::vector<token_ref> token_refs(std::pmr::memory_resource* resource)
+        {
+            std::pmr::vector<token_ref> refs(resource);
+            refs.reserve(estimate_token_count());
+            tokenize_([&](const token_ref& ref) { refs.push_back(ref); });
+            return throw_if_failed_(std::move(refs));
+        }
+#endif
     };
+
+    typedef basic_grammar<no_instrumentation> grammar;
+
+    static_assert(std::is_nothrow_move_constructible<grammar>::value, "moving a grammar must not touch the owner's refcount");
 }
 
 #endif // ASCII_TREE_GRAMMAR_H
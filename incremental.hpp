@@ -0,0 +1,310 @@
+#if !defined(ASCII_TREE_INCREMENTAL_H)
+#define ASCII_TREE_INCREMENTAL_H
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "box_drawing.hpp"
+#include "grammar.hpp"
+
+namespace ascii_tree
+{
+    // replace removed chars at offset with inserted
+    struct text_edit
+    {
+        size_t offset;
+        size_t removed;
+        std::string_view inserted;
+    };
+
+    // the rows an edit re-lexed: [first, first + count)
+    struct edited_rows
+    {
+        size_t first;
+        size_t count;
+    };
+
+    // Keeps a multi-line diagram as a list of lines, each holding its own
+    // tokens, so an edit re-lexes only the lines it touches: the line where it
+    // starts, the line where it ends and any lines it inserts. Every other line
+    // keeps its tokens as they were, and no unchanged char is read again.
+    //
+    // Each row's result (row_result(), with offsets from the start of the row)
+    // is the main API: after an edit, a caller looks at the rows apply()
+    // returns. Finding a row by offset, a row's offset, failed() and error()
+    // take O(log rows) or less, from prefix sums of the line lengths and a
+    // count of failed rows. An edit that adds or removes lines moves every
+    // row after it, so it costs O(rows) to shift the lines and rebuild the sums.
+    //
+    // located_tokens() gives the same result as
+    // grammar::from_box_drawing(text()).located_tokens(): a line with
+    // box-drawing chars is read from an ASCII copy (see box_drawing.hpp), so
+    // offsets count each of them once.
+    class incremental_tokenizer
+    {
+        struct line_
+        {
+            std::string text;                                // without its '\n'
+            parse_result<std::vector<located_token>> result; // row 0, offsets from the start of the line
+            size_t width;                                    // the length of text as the grammar sees it
+        };
+
+        // a count per row, where changing one count and summing the counts
+        // of the first n rows each take O(log rows) (a Fenwick tree)
+        class prefix_sums_
+        {
+            std::vector<size_t> sums_; // sums_[i] holds the counts of rows [i - (i & -i), i)
+
+            static size_t low_bit_(size_t i)
+            {
+                return i & (0 - i);
+            }
+
+        public:
+            template<class CountOf>
+            void assign(size_t rows, CountOf count_of)
+            {
+                sums_.assign(rows + 1, 0);
+                for (size_t i = 1; i <= rows; ++i)
+                {
+                    sums_[i] += count_of(i - 1);
+                    size_t parent = i + low_bit_(i);
+                    if (parent <= rows) { sums_[parent] += sums_[i]; }
+                }
+            }
+
+            // delta may be a negative number cast to size_t
+            void add(size_t row, size_t delta)
+            {
+                for (size_t i = row + 1; i < sums_.size(); i += low_bit_(i)) { sums_[i] += delta; }
+            }
+
+            // the counts of rows [0, rows)
+            size_t sum(size_t rows) const
+            {
+                size_t total = 0;
+                for (size_t i = rows; i > 0; i -= low_bit_(i)) { total += sums_[i]; }
+                return total;
+            }
+
+            // the last row whose preceding counts sum to no more than n, i.e.
+            // the row n falls in if every count is at least 1, or the first
+            // row with a nonzero count if n is 0
+            size_t find(size_t n) const
+            {
+                size_t rows = sums_.size() - 1;
+                size_t step = 1;
+                while (step * 2 <= rows) { step *= 2; }
+
+                size_t row = 0;
+                for (; step > 0; step /= 2)
+                {
+                    if (row + step <= rows && sums_[row + step] <= n)
+                    {
+                        row += step;
+                        n -= sums_[row];
+                    }
+                }
+                return row;
+            }
+        };
+
+        std::vector<line_> lines_;
+        prefix_sums_ chars_;  // each line's text and its '\n'
+        prefix_sums_ widths_; // the same, as the grammar sees them
+        prefix_sums_ errors_; // 1 for each line that failed
+        size_t failed_rows_;
+
+        static line_ lex_(std::string text)
+        {
+            size_t width = is_ascii(text) ? text.size() : ascii_from_box_drawing(text).size();
+
+            std::string_view content(text);
+            if (!content.empty() && content.back() == '\r') { content.remove_suffix(1); }
+
+            auto result = width == text.size()
+                ? grammar(content).try_located_tokens()
+                : grammar::from_box_drawing(content).try_located_tokens();
+            return line_{ std::move(text), std::move(result), width };
+        }
+
+        template<class Lines>
+        static void split_(std::string_view text, Lines& lines)
+        {
+            for (;;)
+            {
+                size_t end = text.find('\n');
+                lines.push_back(lex_(std::string(text.substr(0, end))));
+                if (end == std::string_view::npos) { return; }
+                text.remove_prefix(end + 1);
+            }
+        }
+
+        void sum_rows_()
+        {
+            chars_.assign(lines_.size(), [&](size_t row) { return lines_[row].text.size() + 1; });
+            widths_.assign(lines_.size(), [&](size_t row) { return lines_[row].width + 1; });
+            errors_.assign(lines_.size(), [&](size_t row) { return lines_[row].result ? 0 : 1; });
+
+            failed_rows_ = 0;
+            for (auto& line : lines_) { failed_rows_ += line.result ? 0 : 1; }
+        }
+
+        void replace_row_(size_t row, line_&& line)
+        {
+            auto& old = lines_[row];
+            chars_.add(row, line.text.size() - old.text.size());
+            widths_.add(row, line.width - old.width);
+            size_t failed = line.result ? 0 : 1;
+            errors_.add(row, failed - (old.result ? 0 : 1));
+            failed_rows_ += failed - (old.result ? 0 : 1);
+            old = std::move(line);
+        }
+
+        // the row holding offset, which becomes an offset into that row; an
+        // offset just past a line's last char is that line's '\n'
+        size_t row_at_(size_t& offset) const
+        {
+            size_t row = std::min(chars_.find(offset), lines_.size() - 1);
+            offset -= chars_.sum(row);
+            return row;
+        }
+
+    public:
+        explicit incremental_tokenizer(std::string_view text)
+        {
+            split_(text, lines_);
+            sum_rows_();
+        }
+
+        // applies the edit and returns the rows it re-lexed; offset + removed
+        // must not be past the end of text()
+        edited_rows apply(const text_edit& edit)
+        {
+            size_t first_column = edit.offset;
+            size_t first = row_at_(first_column);
+            size_t last_column = edit.offset + edit.removed;
+            size_t last = row_at_(last_column);
+
+            std::string text = lines_[first].text.substr(0, first_column);
+            text.append(edit.inserted.data(), edit.inserted.size());
+            text.append(lines_[last].text, last_column, std::string::npos);
+
+            std::vector<line_> replacement;
+            split_(text, replacement);
+
+            size_t replaced = last - first + 1;
+            if (replacement.size() == replaced)
+            {
+                for (size_t i = 0; i < replaced; ++i) { replace_row_(first + i, std::move(replacement[i])); }
+                return edited_rows{ first, replaced };
+            }
+
+            size_t common = std::min(replacement.size(), replaced);
+            std::move(replacement.begin(), replacement.begin() + common, lines_.begin() + first);
+            if (replacement.size() > common)
+            {
+                lines_.insert(lines_.begin() + first + common,
+                    std::make_move_iterator(replacement.begin() + common), std::make_move_iterator(replacement.end()));
+            }
+            else
+            {
+                lines_.erase(lines_.begin() + first + common, lines_.begin() + last + 1);
+            }
+            sum_rows_();
+
+            return edited_rows{ first, replacement.size() };
+        }
+
+        size_t rows() const
+        {
+            return lines_.size();
+        }
+
+        std::string_view line(size_t row) const
+        {
+            return lines_[row].text;
+        }
+
+        std::string text() const
+        {
+            std::string text;
+            for (size_t row = 0; row < lines_.size(); ++row)
+            {
+                if (row > 0) { text += '\n'; }
+                text += lines_[row].text;
+            }
+            return text;
+        }
+
+        // the offset of the row's first char, as the grammar counts offsets
+        size_t row_offset(size_t row) const
+        {
+            return widths_.sum(row);
+        }
+
+        // the tokens of one row, or the row's first error, with columns but
+        // with offsets from the start of the row (see row_offset())
+        const parse_result<std::vector<located_token>>& row_result(size_t row) const
+        {
+            return lines_[row].result;
+        }
+
+        // row_result(row).value(); empty when the row has an error
+        const std::vector<located_token>& row_tokens(size_t row) const
+        {
+            return lines_[row].result.value();
+        }
+
+        bool failed() const
+        {
+            return failed_rows_ != 0;
+        }
+
+        // the first error, as grammar::from_box_drawing(text()) reports it;
+        // only meaningful when failed()
+        parse_error error() const
+        {
+            size_t row = errors_.find(0);
+            parse_error e = lines_[row].result.error();
+            e.pos += row_offset(row);
+            return e;
+        }
+
+        // every row's tokens, with offsets from the start of text(); this
+        // reads every token, so a caller that tracks edits should prefer
+        // row_result()
+        parse_result<std::vector<located_token>> try_located_tokens() const
+        {
+            if (failed()) { return parse_result<std::vector<located_token>>(error()); }
+
+            std::vector<located_token> located;
+            size_t begin = 0;
+            for (size_t row = 0; row < lines_.size(); ++row)
+            {
+                for (auto tok : lines_[row].result.value())
+                {
+                    tok.ref.offset += begin;
+                    tok.row = row;
+                    located.push_back(tok);
+                }
+                begin += lines_[row].width + 1;
+            }
+            return parse_result<std::vector<located_token>>(std::move(located));
+        }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        std::vector<located_token> located_tokens() const
+        {
+            auto result = try_located_tokens();
+            if (!result) { throw parse_exception(ascii_from_box_drawing(text()), result.error().pos); }
+            return std::move(result.value());
+        }
+#endif
+    };
+}
+
+#endif // ASCII_TREE_INCREMENTAL_H
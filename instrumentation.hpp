@@ -0,0 +1,111 @@
+#if !defined(ASCII_TREE_INSTRUMENTATION_H)
+#define ASCII_TREE_INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include "grammar.hpp"
+#include "parser.hpp"
+
+namespace ascii_tree
+{
+    // Counts what a parser and grammar do while they tokenize, e.g.
+    //
+    //     basic_grammar<counting_instrumentation> g(text);
+    //     g.tokens();
+    //     g.instrumentation().lookaheads
+    //
+    // Each grammar (and each copy of a parser) counts for itself; the grammar
+    // adds in the counts of the grammars it makes for single lines and threads.
+    struct counting_instrumentation
+    {
+        static constexpr size_t token_types = token::vertical_edge_part + 1;
+
+        size_t ignores = 0;          // calls to ignore(), including those accept() makes
+        size_t ignored_chars = 0;    // chars they skipped
+        size_t unignores = 0;
+        size_t unignored_chars = 0;  // chars unignore() gave back
+        size_t lookaheads = 0;       // rewinds; the grammar rewinds once after each lookahead
+        std::array<size_t, token_types> tokens{}; // indexed by token::toktype
+
+        void ignored(size_t chars)
+        {
+            ++ignores;
+            ignored_chars += chars;
+        }
+
+        void unignored(size_t chars)
+        {
+            ++unignores;
+            unignored_chars += chars;
+        }
+
+        void rewound()
+        {
+            ++lookaheads;
+        }
+
+        void tokenized(token::toktype type)
+        {
+            ++tokens[type];
+        }
+
+        void begin(parse_phase) {}
+        void end(parse_phase) {}
+
+        void merge(const counting_instrumentation& other)
+        {
+            ignores += other.ignores;
+            ignored_chars += other.ignored_chars;
+            unignores += other.unignores;
+            unignored_chars += other.unignored_chars;
+            lookaheads += other.lookaheads;
+            for (size_t type = 0; type < token_types; ++type) { tokens[type] += other.tokens[type]; }
+        }
+
+        size_t token_count() const
+        {
+            size_t count = 0;
+            for (auto n : tokens) { count += n; }
+            return count;
+        }
+    };
+
+    // counting_instrumentation plus the wall-clock time spent in each
+    // parse_phase, summed over every time the phase ran
+    struct timing_instrumentation : counting_instrumentation
+    {
+        typedef std::chrono::steady_clock clock;
+
+        static constexpr size_t phases = static_cast<size_t>(parse_phase::recover) + 1;
+
+        std::array<clock::duration, phases> elapsed{}; // indexed by parse_phase
+
+    private:
+        std::array<clock::time_point, phases> started_{};
+
+    public:
+        clock::duration elapsed_in(parse_phase phase) const
+        {
+            return elapsed[static_cast<size_t>(phase)];
+        }
+
+        void begin(parse_phase phase)
+        {
+            started_[static_cast<size_t>(phase)] = clock::now();
+        }
+
+        void end(parse_phase phase)
+        {
+            elapsed[static_cast<size_t>(phase)] += clock::now() - started_[static_cast<size_t>(phase)];
+        }
+
+        void merge(const timing_instrumentation& other)
+        {
+            counting_instrumentation::merge(other);
+            for (size_t phase = 0; phase < phases; ++phase) { elapsed[phase] += other.elapsed[phase]; }
+        }
+    };
+}
+
+#endif // ASCII_TREE_INSTRUMENTATION_H
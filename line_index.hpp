@@ -0,0 +1,64 @@
+#if !defined(ASCII_TREE_LINE_INDEX_H)
+#define ASCII_TREE_LINE_INDEX_H
+
+#include <algorithm>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace ascii_tree
+{
+    // The offset at which each line of a text starts, found in a single pass.
+    // A line's end excludes its '\n' and any '\r' before it.
+    class line_index
+    {
+        std::string_view s_;
+        std::pmr::vector<size_t> starts_;
+
+    public:
+        explicit line_index(std::string_view s, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : s_(s), starts_(resource)
+        {
+            starts_.push_back(0);
+
+            const char* begin = s.data();
+            const char* end = begin + s.size();
+            for (const char* p = begin;
+                p != end && (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr; )
+            {
+                ++p;
+                starts_.push_back(p - begin);
+            }
+        }
+
+        size_t rows() const
+        {
+            return starts_.size();
+        }
+
+        size_t line_begin(size_t row) const
+        {
+            return starts_[row];
+        }
+
+        size_t line_end(size_t row) const
+        {
+            size_t end = row + 1 < starts_.size() ? starts_[row + 1] - 1 : s_.size();
+            if (end > starts_[row] && s_[end - 1] == '\r') { --end; }
+            return end;
+        }
+
+        std::string_view line(size_t row) const
+        {
+            return s_.substr(line_begin(row), line_end(row) - line_begin(row));
+        }
+
+        size_t row_of(size_t offset) const
+        {
+            return std::upper_bound(starts_.begin(), starts_.end(), offset) - starts_.begin() - 1;
+        }
+    };
+}
+
+#endif // ASCII_TREE_LINE_INDEX_H
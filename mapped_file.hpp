@@ -0,0 +1,129 @@
+#if !defined(ASCII_TREE_MAPPED_FILE_H)
+#define ASCII_TREE_MAPPED_FILE_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include "grammar.hpp"
+
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ascii_tree
+{
+    // A read-only mapping of a whole file. Pages are read in as they are
+    // touched, so nothing is copied into user space up front.
+    class mapped_file
+    {
+        const char* data_;
+        size_t size_;
+
+#if defined(_WIN32)
+        static void throw_last_error_(const char* what)
+        {
+            throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), what);
+        }
+#else
+        static void throw_errno_(const char* what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+#endif
+
+    public:
+        explicit mapped_file(const std::string& path)
+            : data_(nullptr), size_(0)
+        {
+#if defined(_WIN32)
+            HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) { throw_last_error_("CreateFile"); }
+
+            LARGE_INTEGER size;
+            if (!::GetFileSizeEx(file, &size)) { ::CloseHandle(file); throw_last_error_("GetFileSizeEx"); }
+            size_ = static_cast<size_t>(size.QuadPart);
+
+            if (size_ != 0)
+            {
+                HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                ::CloseHandle(file);
+                if (mapping == nullptr) { throw_last_error_("CreateFileMapping"); }
+
+                data_ = static_cast<const char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                ::CloseHandle(mapping);
+                if (data_ == nullptr) { throw_last_error_("MapViewOfFile"); }
+            }
+            else
+            {
+                ::CloseHandle(file);
+            }
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) { throw_errno_("open"); }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0) { int err = errno; ::close(fd); errno = err; throw_errno_("fstat"); }
+            size_ = static_cast<size_t>(st.st_size);
+
+            if (size_ != 0)
+            {
+                void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                int err = errno;
+                ::close(fd);
+                if (data == MAP_FAILED) { errno = err; throw_errno_("mmap"); }
+
+                ::madvise(data, size_, MADV_SEQUENTIAL); // only a hint, so failure is harmless
+                data_ = static_cast<const char*>(data);
+            }
+            else
+            {
+                ::close(fd);
+            }
+#endif
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        ~mapped_file()
+        {
+            if (data_ == nullptr) { return; }
+#if defined(_WIN32)
+            ::UnmapViewOfFile(data_);
+#else
+            ::munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+
+        std::string_view view() const
+        {
+            return std::string_view(data_, size_);
+        }
+    };
+
+    // maps the file read-only and tokenizes the mapping in place, e.g.
+    //
+    //     auto tokens = grammar_from_file(path).tokens();
+    //
+    // This lives here rather than in grammar.hpp to keep the OS headers out of it.
+    template<class Instrumentation = no_instrumentation>
+    basic_grammar<Instrumentation> grammar_from_file(const std::string& path)
+    {
+        auto file = std::make_shared<const mapped_file>(path);
+        auto view = file->view();
+        return basic_grammar<Instrumentation>(std::move(file), view);
+    }
+}
+
+#endif // ASCII_TREE_MAPPED_FILE_H
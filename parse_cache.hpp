@@ -0,0 +1,204 @@
+#if !defined(ASCII_TREE_PARSE_CACHE_H)
+#define ASCII_TREE_PARSE_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "grammar.hpp"
+
+namespace ascii_tree
+{
+    // XXH64 of the text: about one multiply per 8 bytes, and the same value as
+    // the reference implementation on little-endian machines
+    inline uint64_t content_hash(std::string_view text, uint64_t seed = 0)
+    {
+        constexpr uint64_t p1 = 0x9E3779B185EBCA87ull, p2 = 0xC2B2AE3D27D4EB4Full, p3 = 0x165667B19E3779F9ull,
+            p4 = 0x85EBCA77C2B2AE63ull, p5 = 0x27D4EB2F165667C5ull;
+
+        auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+        auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * p2, 31) * p1; };
+        auto merge = [&](uint64_t acc, uint64_t v) { return (acc ^ round(0, v)) * p1 + p4; };
+        auto read64 = [](const char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; };
+        auto read32 = [](const char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; };
+
+        const char* p = text.data();
+        const char* end = p + text.size();
+        uint64_t h;
+
+        if (text.size() >= 32)
+        {
+            uint64_t v1 = seed + p1 + p2, v2 = seed + p2, v3 = seed, v4 = seed - p1;
+            for (; end - p >= 32; p += 32)
+            {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+        }
+        else
+        {
+            h = seed + p5;
+        }
+
+        h += text.size();
+        for (; end - p >= 8; p += 8) { h = rotl(h ^ round(0, read64(p)), 27) * p1 + p4; }
+        if (end - p >= 4)
+        {
+            h = rotl(h ^ (read32(p) * p1), 23) * p2 + p3;
+            p += 4;
+        }
+        for (; p != end; ++p) { h = rotl(h ^ (static_cast<unsigned char>(*p) * p5), 11) * p1; }
+
+        h ^= h >> 33;
+        h *= p2;
+        h ^= h >> 29;
+        h *= p3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // A bounded, thread-safe cache of parse results keyed by content_hash() of
+    // the input. A hit costs a hash, a lookup and a compare of the text (so a
+    // hash collision is a miss, never a wrong result); a miss parses outside
+    // the lock, so threads only wait on each other for the bookkeeping. Results
+    // are shared and immutable, and stay valid after they are evicted. When the
+    // cache is full the least recently used entry is evicted.
+    template<class Result>
+    class parse_cache
+    {
+    public:
+        struct entry
+        {
+            std::string source;
+            Result result;
+        };
+
+        struct statistics
+        {
+            size_t hits;
+            size_t misses;
+            size_t evictions;
+        };
+
+    private:
+        typedef std::pair<uint64_t, std::shared_ptr<const entry>> item_;
+
+        size_t capacity_;
+        std::function<Result(std::string_view)> parse_;
+
+        mutable std::mutex m_;
+        std::list<item_> lru_; // most recently used first
+        std::unordered_map<uint64_t, typename std::list<item_>::iterator> index_;
+        statistics stats_{};
+
+        // with m_ held
+        std::shared_ptr<const entry> find_(uint64_t hash, std::string_view text)
+        {
+            auto found = index_.find(hash);
+            if (found == index_.end() || found->second->second->source != text) { return nullptr; }
+
+            lru_.splice(lru_.begin(), lru_, found->second);
+            return found->second->second;
+        }
+
+    public:
+        // parse is called with each input that misses; capacity is in entries
+        parse_cache(size_t capacity, std::function<Result(std::string_view)> parse)
+            : capacity_(capacity > 0 ? capacity : 1), parse_(std::move(parse))
+        {}
+
+        parse_cache(const parse_cache&) = delete;
+        parse_cache& operator=(const parse_cache&) = delete;
+
+        std::shared_ptr<const entry> get(std::string_view text)
+        {
+            uint64_t hash = content_hash(text);
+            {
+                std::lock_guard<std::mutex> lock(m_);
+                if (auto hit = find_(hash, text))
+                {
+                    ++stats_.hits;
+                    return hit;
+                }
+                ++stats_.misses;
+            }
+
+            auto parsed = std::make_shared<const entry>(entry{ std::string(text), parse_(text) });
+
+            std::lock_guard<std::mutex> lock(m_);
+            if (auto raced = find_(hash, text)) { return raced; } // another thread parsed it first
+
+            auto found = index_.find(hash);
+            if (found != index_.end()) // a different text with the same hash
+            {
+                lru_.erase(found->second);
+                index_.erase(found);
+            }
+            else if (lru_.size() == capacity_)
+            {
+                index_.erase(lru_.back().first);
+                lru_.pop_back();
+                ++stats_.evictions;
+            }
+
+            lru_.emplace_front(hash, parsed);
+            index_.emplace(hash, lru_.begin());
+            return parsed;
+        }
+
+        statistics stats() const
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            return stats_;
+        }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            return lru_.size();
+        }
+
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            lru_.clear();
+            index_.clear();
+        }
+    };
+
+    // caches grammar(text).try_tokens()
+    class token_cache : public parse_cache<parse_result<std::vector<token>>>
+    {
+    public:
+        explicit token_cache(size_t capacity)
+            : parse_cache(capacity, [](std::string_view text) { return grammar(text).try_tokens(); })
+        {}
+    };
+
+    // caches grammar(text).try_located_tokens(), for multi-line diagrams
+    class located_token_cache : public parse_cache<parse_result<std::vector<located_token>>>
+    {
+    public:
+        explicit located_token_cache(size_t capacity)
+            : parse_cache(capacity, [](std::string_view text) { return grammar(text).try_located_tokens(); })
+        {}
+    };
+}
+
+#endif // ASCII_TREE_PARSE_CACHE_H
@@ -1,9 +1,19 @@
 #if !defined(ASCII_TREE_PARSER_H)
 #define ASCII_TREE_PARSER_H
 
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#define ASCII_TREE_EXCEPTIONS 1
+#endif
 
 namespace ascii_tree
 {
@@ -16,117 +26,351 @@ namespace ascii_tree
         parse_exception(const std::string& s, size_t pos) : s(s), pos(pos) {}
     };
 
+    // a 256-entry lookup table built at compile time from TerminalTraits::classify
+    template<class TerminalTraits>
+    struct terminal_table
+    {
+        typedef typename TerminalTraits::type terminal;
+        typedef std::array<terminal, 256> table_type;
+
+        static constexpr table_type make()
+        {
+            table_type table{};
+            for (size_t i = 0; i < table.size(); ++i)
+            {
+                table[i] = TerminalTraits::classify(static_cast<char>(i));
+            }
+            return table;
+        }
+
+        static constexpr table_type table = make();
+
+        static constexpr terminal lookup(char ch)
+        {
+            return table[static_cast<unsigned char>(ch)];
+        }
+    };
+
+    // derive a traits class from this and give it a constexpr classify(char) to
+    // get a to_terminal(char) that is a single table load
+    template<class Derived>
+    struct table_terminal_traits
+    {
+        static constexpr auto to_terminal(char ch)
+        {
+            return terminal_table<Derived>::lookup(ch);
+        }
+    };
+
+    // detects an optional TerminalTraits::scan(term, first, last) that returns
+    // the end of the run of term and ignore_me chars starting at first
+    template<class TerminalTraits, class = void>
+    struct has_scan : std::false_type {};
+
+    template<class TerminalTraits>
+    struct has_scan<TerminalTraits, std::void_t<decltype(TerminalTraits::scan(
+        std::declval<typename TerminalTraits::type>(), std::declval<const char*>(), std::declval<const char*>()))>>
+        : std::true_type {};
+
+    // An instrumentation policy is told about the parser's work as it happens
+    // (and about the grammar's, see basic_grammar). This one, the default,
+    // ignores everything: its hooks are empty and inline and it takes no
+    // space, so a parser that uses it compiles to the same code as one with no
+    // hooks at all. instrumentation.hpp has policies that count and time.
+    struct no_instrumentation
+    {
+        void ignored(size_t /*chars*/) {}
+        void unignored(size_t /*chars*/) {}
+        void rewound() {}
+        template<class TokenType> void tokenized(TokenType) {}
+        template<class Phase> void begin(Phase) {}
+        template<class Phase> void end(Phase) {}
+        void merge(const no_instrumentation&) {}
+    };
+
+    template<class TerminalTraits, class Instrumentation = no_instrumentation>
+    class parser;
+
+    // an offset into a parser's input; it neither owns nor keeps the input
+    // alive, so copying one is as cheap as copying two pointers and a size_t
     class position
     {
-        std::shared_ptr<const std::string> s_;
-        std::string::const_iterator it_;
+        std::string_view source_;
+        size_t offset_;
 
-        position(std::shared_ptr<const std::string>& s, std::string::const_iterator it) : s_(s), it_(it) {}
+        position(std::string_view source, size_t offset)
+            : source_(source), offset_(offset)
+        {}
 
-        template<class T>
+        template<class T, class I>
         friend class parser;
 
         friend bool operator==(const position& lhs, const position& rhs)
         {
-            return lhs.s_ == rhs.s_ &&
-                lhs.it_ == rhs.it_;
+            return lhs.source_.data() == rhs.source_.data() &&
+                lhs.offset_ == rhs.offset_;
         }
 
     public:
+        size_t offset() const
+        {
+            return offset_;
+        }
+
         std::wstring to_string() const
         {
             return std::wstring(L"position=") + 
-                std::to_wstring(std::distance(s_->begin(), it_)) + L"/" + 
-                std::to_wstring(s_->length()) + L" (" +
-                (it_ == s_->end() ? L"<end>" : std::wstring(1, *it_)) + L")";
+                std::to_wstring(offset_) + L"/" + 
+                std::to_wstring(source_.size()) + L" (" +
+                (offset_ == source_.size() ? L"<end>" : std::wstring(1, source_[offset_])) + L")";
         }
     };
 
-    template<class TerminalTraits>
-    class parser
+    static_assert(std::is_trivially_copyable<position>::value, "position must stay cheap to copy");
+
+    // the parser derives from Instrumentation so that an empty policy adds
+    // nothing to its size
+    template<class TerminalTraits, class Instrumentation>
+    class parser : private Instrumentation
     {
         typedef typename TerminalTraits::type terminal;
 
-        std::shared_ptr<const std::string> s_;
-        std::string::const_iterator it_;
+        // owner_ keeps the input alive when the parser was handed a std::string;
+        // it is empty when the parser borrows a std::string_view from the caller
+        std::shared_ptr<const void> owner_;
+        const char* begin_;
+        const char* end_;
+        const char* it_;
+        const char* error_ = nullptr; // where the first failed check() stopped
+
+        const char* skip_(terminal term)
+        {
+            if constexpr (has_scan<TerminalTraits>::value)
+            {
+                return TerminalTraits::scan(term, it_, end_);
+            }
+            else
+            {
+                auto it = it_;
+                while (it != end_)
+                {
+                    terminal next_term = TerminalTraits::to_terminal(*it);
+                    if (next_term != term && next_term != TerminalTraits::ignore_me) { break; }
+                    ++it;
+                }
+                return it;
+            }
+        }
 
-        std::string::const_iterator accept_(terminal term)
+        const char* accept_(terminal term)
         {
+            if (error_) { return end_; }
             ignore();
-            if (at_end()) { return s_->end(); }
+            if (at_end()) { return end_; }
 
             terminal next_term = TerminalTraits::to_terminal(*it_);
-            return (term == next_term) ? it_++ : s_->end();
+            return (term == next_term) ? it_++ : end_;
         }
 
+        template<class String>
+        parser(std::shared_ptr<const String>&& s, size_t init_pos)
+            : owner_(s), begin_(s->data()), end_(s->data() + s->size()), it_(begin_ + init_pos)
+        {}
+
     public:
         explicit parser(const std::string& s)
             : parser(s, 0)
         {}
 
         parser(const std::string& s, size_t init_pos)
-            : s_(std::make_shared<const std::string>(s)), it_(s_->begin() + init_pos)
+            : parser(std::make_shared<const std::string>(s), init_pos)
+        {}
+
+        // takes ownership of the string, so the input is never copied
+        explicit parser(std::string&& s)
+            : parser(std::move(s), 0)
+        {}
+
+        parser(std::string&& s, size_t init_pos)
+            : parser(std::make_shared<const std::string>(std::move(s)), init_pos)
+        {}
+
+        explicit parser(const char* s)
+            : parser(std::string(s), 0)
+        {}
+
+        parser(const char* s, size_t init_pos)
+            : parser(std::string(s), init_pos)
+        {}
+
+        // borrows the caller's chars without copying them; the caller must keep
+        // them alive for as long as the parser (or any copy of it) is in use
+        explicit parser(std::string_view s)
+            : parser(s, 0)
         {}
 
-        parser(const parser& other)
-            : s_(other.s_), it_(other.it_)
+        parser(std::string_view s, size_t init_pos)
+            : begin_(s.data()), end_(s.data() + s.size()), it_(begin_ + init_pos)
         {}
 
+        // copies s into memory from the resource: one allocation holds the
+        // control block and the pmr::string, and a second holds the chars when
+        // s is too long for the string's small buffer. Both come from the
+        // resource, so releasing it releases the parser's input with it.
+        parser(std::string_view s, const std::pmr::polymorphic_allocator<char>& alloc)
+            : parser(std::shared_ptr<const std::pmr::string>(std::allocate_shared<std::pmr::string>(alloc, s)), 0)
+        {}
+
+        // borrows s and keeps owner (whatever holds s's chars) alive alongside it
+        parser(std::shared_ptr<const void> owner, std::string_view s)
+            : owner_(std::move(owner)), begin_(s.data()), end_(s.data() + s.size()), it_(begin_)
+        {}
+
+        Instrumentation& instrumentation()
+        {
+            return *this;
+        }
+
+        const Instrumentation& instrumentation() const
+        {
+            return *this;
+        }
+
         void ignore()
         {
-            if (at_end()) { return; }
-            while (TerminalTraits::to_terminal(*it_) == TerminalTraits::ignore_me && ++it_ != s_->end()) {}
+            auto it = skip_(TerminalTraits::ignore_me);
+            instrumentation().ignored(std::distance(it_, it));
+            it_ = it;
         }
 
         void unignore()
         {
+            auto it = it_;
             while (!at_begin() &&
                 TerminalTraits::to_terminal(*(it_ - 1)) == TerminalTraits::ignore_me)
             {
                 --it_;
             }
+            instrumentation().unignored(std::distance(it_, it));
         }
 
         position current_position()
         {
-            return position(s_, it_);
+            return position(source(), offset());
+        }
+
+        // moves back (or forward) to a position taken from this parser, e.g.
+        // after looking ahead with accept(); a recorded error stays recorded
+        void rewind(position pos)
+        {
+            instrumentation().rewound();
+            it_ = begin_ + pos.offset_;
+        }
+
+        size_t offset()
+        {
+            return std::distance(begin_, it_);
+        }
+
+        std::string_view source()
+        {
+            return std::string_view(begin_, std::distance(begin_, end_));
         }
 
         bool at_begin()
         {
-            return it_ == s_->begin();
+            return it_ == begin_;
         }
 
         bool at_end()
         {
-            return it_ == s_->end();
+            return it_ == end_;
         }
 
         bool accept(terminal term)
         {
-            return accept_(term) != s_->end();
+            return accept_(term) != end_;
         }
 
-        position expect(terminal term)
+        // same as while (accept(term)) {}, but consumes the whole run at once;
+        // like accept(), it reports the spaces it passes over as ignored
+        void accept_all(terminal term)
+        {
+            if (error_) { return; }
+
+            auto it = skip_(term);
+            if constexpr (!std::is_same<Instrumentation, no_instrumentation>::value)
+            {
+                auto spaces = std::count_if(it_, it, [](char ch) { return TerminalTraits::to_terminal(ch) == TerminalTraits::ignore_me; });
+                if (spaces != 0) { instrumentation().ignored(static_cast<size_t>(spaces)); }
+            }
+            it_ = it;
+        }
+
+        // expect() without the exception: on a mismatch it records the error
+        // and returns the current position, and from then on every accept fails
+        position check(terminal term)
         {
             auto it = accept_(term);
-            if (it == s_->end())
+            if (it == end_)
             {
-                throw parse_exception(*s_, std::distance(s_->begin(), it_));
+                fail();
+                return current_position();
             }
 
-            return position(s_, it);
+            return position(source(), std::distance(begin_, it));
+        }
+
+        // records an error at the current position, unless one was already recorded
+        void fail()
+        {
+            if (!error_) { error_ = it_; }
+        }
+
+        void fail_at(size_t offset)
+        {
+            if (!error_) { error_ = begin_ + offset; }
+        }
+
+        // forgets any recorded error and carries on from offset
+        void recover_at(size_t offset)
+        {
+            error_ = nullptr;
+            it_ = begin_ + offset;
+        }
+
+        bool failed()
+        {
+            return error_ != nullptr;
+        }
+
+        size_t error_offset()
+        {
+            return std::distance(begin_, error_);
+        }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        position expect(terminal term)
+        {
+            auto pos = check(term);
+            if (failed()) { error(); }
+            return pos;
         }
+#endif
 
         std::string substring(position start)
         {
-            return std::string(start.it_, it_);
+            return std::string(begin_ + start.offset_, it_);
         }
 
+#if defined(ASCII_TREE_EXCEPTIONS)
+        // throws the recorded error, or an error at the current position
         void error()
         {
-            throw parse_exception(*s_, std::distance(s_->begin(), it_));
+            fail();
+            throw parse_exception(std::string(begin_, end_), error_offset());
         }
+#endif
     };
 
 }
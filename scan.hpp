@@ -0,0 +1,251 @@
+#if !defined(ASCII_TREE_SCAN_H)
+#define ASCII_TREE_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#define ASCII_TREE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASCII_TREE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Run-length scanners: each returns the first position in [first, last) whose
+// char is outside the run, checking 32 (AVX2) or 16 (SSE2) chars per step and
+// finishing the tail one char at a time. Counters work the same way, but
+// read every char.
+
+namespace ascii_tree { namespace scan
+{
+    inline unsigned count_trailing_zeros_(uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    inline unsigned count_bits_(uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        return __popcnt(mask);
+#else
+        return __builtin_popcount(mask);
+#endif
+    }
+
+    struct either_char_
+    {
+        char a, b;
+
+        bool operator()(char ch) const { return ch == a || ch == b; }
+
+#if defined(ASCII_TREE_SSE2)
+        __m128i operator()(__m128i v) const
+        {
+            return _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_set1_epi8(a)),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8(b)));
+        }
+#endif
+
+#if defined(ASCII_TREE_AVX2)
+        __m256i operator()(__m256i v) const
+        {
+            return _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8(a)),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8(b)));
+        }
+#endif
+    };
+
+    // [A-Za-z0-9_] or the extra char
+    struct name_char_or_
+    {
+        char extra;
+
+        bool operator()(char ch) const
+        {
+            char lower = static_cast<char>(ch | 0x20);
+            return (lower >= 'a' && lower <= 'z') || (ch >= '0' && ch <= '9') || ch == '_' || ch == extra;
+        }
+
+#if defined(ASCII_TREE_SSE2)
+        static __m128i in_range_(__m128i v, char lo, char hi)
+        {
+            return _mm_and_si128(
+                _mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+        }
+
+        __m128i operator()(__m128i v) const
+        {
+            __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+            return _mm_or_si128(
+                _mm_or_si128(in_range_(lower, 'a', 'z'), in_range_(v, '0', '9')),
+                _mm_or_si128(
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8(extra))));
+        }
+#endif
+
+#if defined(ASCII_TREE_AVX2)
+        static __m256i in_range_(__m256i v, char lo, char hi)
+        {
+            return _mm256_and_si256(
+                _mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+        }
+
+        __m256i operator()(__m256i v) const
+        {
+            __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+            return _mm256_or_si256(
+                _mm256_or_si256(in_range_(lower, 'a', 'z'), in_range_(v, '0', '9')),
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')),
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8(extra))));
+        }
+#endif
+    };
+
+    // a char below 0x80; with SSE2 or AVX2 that is just its sign bit
+    struct ascii_
+    {
+        bool operator()(char ch) const
+        {
+            return static_cast<unsigned char>(ch) < 0x80;
+        }
+
+#if defined(ASCII_TREE_SSE2)
+        __m128i operator()(__m128i v) const
+        {
+            return _mm_cmpgt_epi8(v, _mm_set1_epi8(-1));
+        }
+#endif
+
+#if defined(ASCII_TREE_AVX2)
+        __m256i operator()(__m256i v) const
+        {
+            return _mm256_cmpgt_epi8(v, _mm256_set1_epi8(-1));
+        }
+#endif
+    };
+
+    // the chars that start a token: '[', '(', '/', '\\' and '|'
+    struct token_start_
+    {
+        bool operator()(char ch) const
+        {
+            return ch == '[' || ch == '(' || ch == '/' || ch == '\\' || ch == '|';
+        }
+
+#if defined(ASCII_TREE_SSE2)
+        __m128i operator()(__m128i v) const
+        {
+            return _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')), _mm_cmpeq_epi8(v, _mm_set1_epi8('('))),
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('/')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8('|'))));
+        }
+#endif
+
+#if defined(ASCII_TREE_AVX2)
+        __m256i operator()(__m256i v) const
+        {
+            return _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('('))),
+                _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('|'))));
+        }
+#endif
+    };
+
+    template<class Matcher>
+    const char* skip_run_(const char* first, const char* last, Matcher match)
+    {
+#if defined(ASCII_TREE_AVX2)
+        while (last - first >= 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match(v)));
+            if (mask != 0xFFFFFFFFu) { return first + count_trailing_zeros_(~mask); }
+            first += 32;
+        }
+#endif
+#if defined(ASCII_TREE_SSE2)
+        while (last - first >= 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match(v)));
+            if (mask != 0xFFFFu) { return first + count_trailing_zeros_(~mask & 0xFFFFu); }
+            first += 16;
+        }
+#endif
+        while (first != last && match(*first)) { ++first; }
+        return first;
+    }
+
+    template<class Matcher>
+    size_t count_(const char* first, const char* last, Matcher match)
+    {
+        size_t count = 0;
+#if defined(ASCII_TREE_AVX2)
+        for (; last - first >= 32; first += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            count += count_bits_(static_cast<uint32_t>(_mm256_movemask_epi8(match(v))));
+        }
+#endif
+#if defined(ASCII_TREE_SSE2)
+        for (; last - first >= 16; first += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            count += count_bits_(static_cast<uint32_t>(_mm_movemask_epi8(match(v))));
+        }
+#endif
+        for (; first != last; ++first) { count += match(*first); }
+        return count;
+    }
+
+    inline const char* skip_char(const char* first, const char* last, char ch)
+    {
+        return skip_run_(first, last, either_char_{ ch, ch });
+    }
+
+    inline const char* skip_either_char(const char* first, const char* last, char a, char b)
+    {
+        return skip_run_(first, last, either_char_{ a, b });
+    }
+
+    inline const char* skip_name_chars_or(const char* first, const char* last, char extra)
+    {
+        return skip_run_(first, last, name_char_or_{ extra });
+    }
+
+    // the first char that is not ASCII, e.g. the first byte of a UTF-8 sequence
+    inline const char* skip_ascii(const char* first, const char* last)
+    {
+        return skip_run_(first, last, ascii_{});
+    }
+
+    inline size_t count_token_starts(const char* first, const char* last)
+    {
+        return count_(first, last, token_start_{});
+    }
+}}
+
+#endif // ASCII_TREE_SCAN_H
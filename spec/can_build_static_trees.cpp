@@ -0,0 +1,102 @@
+#include "static_tree.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    constexpr auto fixed_chain = make_static_tree("[*]--(a)--[b]-(c)-[d]");
+    static_assert(fixed_chain.size() == 3, "a static_tree is built while compiling");
+    static_assert(fixed_chain.name(2) == "d", "a static_tree's names are usable while compiling");
+
+    TEST_CLASS(can_build_static_trees)
+    {
+        template<size_t N>
+        static vector<string> child_names(const static_tree<N>& t, size_t node)
+        {
+            vector<string> names;
+            for (auto child : t.children(node)) { names.emplace_back(t.name(child)); }
+            return names;
+        }
+
+    public:
+        TEST_METHOD(should_build_an_empty_static_tree_from_an_empty_literal)
+        {
+            constexpr auto t = make_static_tree("");
+            _(t.empty()).should_be_true();
+            _(t.root()).should_be(static_tree<0>::npos);
+        }
+
+        TEST_METHOD(should_link_nodes_along_horizontal_edges_while_compiling)
+        {
+            _(fixed_chain.root()).should_be(0u);
+            _(fixed_chain.parent(1)).should_be(0u);
+            _(fixed_chain.parent(2)).should_be(1u);
+            _(string(fixed_chain.edge_name(1))).should_be("a");
+            _(string(fixed_chain.edge_name(2))).should_be("c");
+        }
+
+        TEST_METHOD(should_link_nodes_along_vertical_and_diagonal_edges_while_compiling)
+        {
+            constexpr auto t = make_static_tree(
+                "     [*]\n"
+                "    / | \\\n"
+                " [a] (x) [c]\n"
+                "      |\n"
+                "     [b]\n");
+
+            auto root = t.root();
+            _(t.name(root).empty()).should_be_true();
+            auto children = child_names(t, root);
+            _(children.size()).should_be(3u);
+            _(children[0]).should_be("a");
+            _(children[1]).should_be("c");
+            _(children[2]).should_be("b");
+            _(string(t.edge_name(3))).should_be("x");
+            _(t.edge_name(1).empty()).should_be_true();
+        }
+
+        TEST_METHOD(should_locate_the_same_tokens_as_the_grammar)
+        {
+            const char diagram[] = "[*]\n |\n[a b] -(x)- [c]\r\n";
+            constexpr auto t = make_static_tree("[*]\n |\n[a b] -(x)- [c]\r\n");
+            auto expected = grammar(diagram).located_tokens();
+
+            _(t.tokens().size()).should_be(expected.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                _(t.tokens()[i] == expected[i]).should_be_true();
+            }
+            _(string(t.name(1))).should_be("a b");
+        }
+
+        TEST_METHOD(should_reject_a_bad_diagram_built_at_run_time)
+        {
+            should_throw_(parse_exception("[*] [a]", 4), []
+            {
+                static_tree<7> t("[*] [a]");
+            });
+        }
+
+        TEST_METHOD(should_reject_a_bad_token_built_at_run_time)
+        {
+            should_throw_(parse_exception("[*]-(a)-[b!]", 10), []
+            {
+                make_static_tree("[*]-(a)-[b!]");
+            });
+        }
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+        TEST_METHOD(should_build_a_static_tree_from_a_literal)
+        {
+            using namespace ascii_tree::literals;
+            constexpr auto& t = "[*]-(a)-[b]"_tree;
+            static_assert(t.size() == 2, "a _tree literal is built while compiling");
+            _(&t == &"[*]-(a)-[b]"_tree).should_be_true();
+            _(string(t.name(1))).should_be("b");
+        }
+#endif
+    };
+}}
@@ -0,0 +1,146 @@
+#include "tree.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_build_trees)
+    {
+        static vector<string> child_names(const tree& t, size_t node)
+        {
+            vector<string> names;
+            for (auto child : t.children(node)) { names.emplace_back(t.name(child)); }
+            return names;
+        }
+
+    public:
+        TEST_METHOD(should_build_an_empty_tree_from_an_empty_string)
+        {
+            grammar g("");
+            tree t(g);
+            _(t.empty()).should_be_true();
+            _(t.root()).should_be(tree::npos);
+        }
+
+        TEST_METHOD(should_build_a_tree_with_only_a_root)
+        {
+            grammar g("[*]");
+            tree t(g);
+            _(t.size()).should_be(1u);
+            _(t.root()).should_be(0u);
+            _(t.parent(0)).should_be(tree::npos);
+            _(t.children(0).empty()).should_be_true();
+        }
+
+        TEST_METHOD(should_link_nodes_along_horizontal_edges)
+        {
+            grammar g("[*]--(a)--[b]-(c)-[d]");
+            tree t(g);
+            _(t.size()).should_be(3u);
+            _(t.parent(1)).should_be(0u);
+            _(t.parent(2)).should_be(1u);
+            _(string(t.edge_name(1))).should_be("a");
+            _(string(t.edge_name(2))).should_be("c");
+        }
+
+        TEST_METHOD(should_link_nodes_along_vertical_and_diagonal_edges)
+        {
+            grammar g(
+                "     [*]\n"
+                "    / | \\\n"
+                " [a] (x) [c]\n"
+                "      |\n"
+                "     [b]\n");
+            tree t(g);
+
+            auto root = t.root();
+            _(t.name(root).empty()).should_be_true();
+            auto children = child_names(t, root);
+            _(children.size()).should_be(3u);
+            _(children[0]).should_be("a");
+            _(children[1]).should_be("c");
+            _(children[2]).should_be("b");
+            _(string(t.edge_name(3))).should_be("x");
+            _(t.edge_name(1).empty()).should_be_true();
+        }
+
+        TEST_METHOD(should_follow_an_edge_that_bends)
+        {
+            grammar g(
+                "[*]\n"
+                "   \\\n"
+                "    \\\n"
+                "     |\n"
+                "    [a]\n");
+            tree t(g);
+            _(t.size()).should_be(2u);
+            _(t.parent(1)).should_be(0u);
+        }
+
+        TEST_METHOD(should_reject_an_edge_that_leads_nowhere)
+        {
+            should_throw_(parse_exception("[*]\n |", 5), []
+            {
+                grammar g("[*]\n |");
+                tree t(g);
+            });
+        }
+
+        TEST_METHOD(should_reject_a_node_without_a_parent)
+        {
+            should_throw_(parse_exception("[*] [a]", 4), []
+            {
+                grammar g("[*] [a]");
+                tree t(g);
+            });
+        }
+
+        TEST_METHOD(should_reject_a_second_root)
+        {
+            should_throw_(parse_exception("[*]-(a)-[*]", 8), []
+            {
+                grammar g("[*]-(a)-[*]");
+                tree t(g);
+            });
+        }
+
+        TEST_METHOD(should_reject_an_edge_part_that_belongs_to_no_edge)
+        {
+            should_throw_(parse_exception("[*]      |", 9), []
+            {
+                grammar g("[*]      |");
+                tree t(g);
+            });
+        }
+
+        TEST_METHOD(should_try_to_build_a_tree_without_throwing)
+        {
+            grammar g("[*]\n |\n[a]");
+            auto result = tree::try_build(g);
+            _(result.has_value()).should_be_true();
+            _(result.value().size()).should_be(2u);
+            _(result.value().parent(1)).should_be(0u);
+        }
+
+        TEST_METHOD(should_report_an_unlinked_token_from_try_build)
+        {
+            grammar g("[*] [a]");
+            auto result = tree::try_build(g);
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(4u);
+            _(result.error().found == open_square_brace).should_be_true();
+        }
+
+        TEST_METHOD(should_report_a_bad_token_from_try_build)
+        {
+            grammar g("[*]\n |\n[a");
+            auto result = tree::try_build(g);
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(9u);
+            _(result.error().code == parse_errc::unexpected_end).should_be_true();
+        }
+    };
+}}
@@ -0,0 +1,100 @@
+#include "parse_cache.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_cache_parses)
+    {
+    public:
+        TEST_METHOD(should_hash_like_xxh64)
+        {
+            _(content_hash("") == 0xEF46DB3751D8E999ull).should_be_true();
+            _(content_hash("a") == 0xD24EC4F1A98C6E5Bull).should_be_true();
+            _(content_hash("abc") == 0x44BC2CF5AD770999ull).should_be_true();
+        }
+
+        TEST_METHOD(should_hash_long_inputs_by_every_byte)
+        {
+            string s(100, 'x');
+            auto h = content_hash(s);
+            s[99] = 'y';
+            _(content_hash(s) != h).should_be_true();
+            s[99] = 'x';
+            s[0] = 'y';
+            _(content_hash(s) != h).should_be_true();
+        }
+
+        TEST_METHOD(should_parse_on_a_miss_and_share_the_result_on_a_hit)
+        {
+            token_cache cache(4);
+            auto first = cache.get("[*]-(a)-[b]");
+            auto second = cache.get(string("[*]-(a)-[b]"));
+
+            _(first.get() == second.get()).should_be_true();
+            _(first->result.value()).should_equal({ root_node(), horizontal_edge("a"), named_node("b") });
+            _(cache.stats().misses).should_be(1u);
+            _(cache.stats().hits).should_be(1u);
+        }
+
+        TEST_METHOD(should_cache_errors_too)
+        {
+            token_cache cache(4);
+            cache.get("[*]]");
+            auto result = cache.get("[*]]");
+            _(result->result.has_value()).should_be_false();
+            _(result->result.error().pos).should_be(3u);
+            _(cache.stats().hits).should_be(1u);
+        }
+
+        TEST_METHOD(should_evict_the_least_recently_used_entry)
+        {
+            token_cache cache(2);
+            auto a = cache.get("[a]");
+            cache.get("[b]");
+            cache.get("[a]");
+            cache.get("[c]"); // evicts [b]
+
+            _(cache.size()).should_be(2u);
+            _(cache.stats().evictions).should_be(1u);
+
+            cache.get("[a]");
+            _(cache.stats().hits).should_be(2u);
+            cache.get("[b]");
+            _(cache.stats().misses).should_be(4u);
+            _(a->result.value()).should_equal({ named_node("a") });
+        }
+
+        TEST_METHOD(should_cache_located_tokens)
+        {
+            located_token_cache cache(1);
+            auto result = cache.get("[*]\n |\n[a]");
+            _(result->result.value().size()).should_be(3u);
+        }
+
+        TEST_METHOD(should_be_shared_by_threads)
+        {
+            token_cache cache(8);
+            vector<thread> threads;
+            for (int t = 0; t < 4; ++t)
+            {
+                threads.emplace_back([&cache, t]
+                {
+                    for (int i = 0; i < 200; ++i)
+                    {
+                        cache.get("[n" + to_string((i + t) % 16) + "]");
+                    }
+                });
+            }
+            for (auto& t : threads) { t.join(); }
+
+            auto stats = cache.stats();
+            _(stats.hits + stats.misses).should_be(800u);
+            _(cache.size() <= 8u).should_be_true();
+        }
+    };
+}}
@@ -0,0 +1,126 @@
+#include "grammar.hpp"
+#include "instrumentation.hpp"
+#include "parser.hpp"
+#include "test_helpers.hpp"
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_instrument_parses)
+    {
+        typedef basic_grammar<counting_instrumentation> counting_grammar;
+
+        static size_t count_of(const counting_instrumentation& stats, token::toktype type)
+        {
+            return stats.tokens[type];
+        }
+
+    public:
+        TEST_METHOD(should_add_nothing_to_the_default_parser_and_grammar)
+        {
+            _(is_empty<no_instrumentation>::value).should_be_true();
+            _(sizeof(parser<terminal_traits>)).should_be(sizeof(shared_ptr<const void>) + 4 * sizeof(const char*));
+            _(sizeof(grammar)).should_be(sizeof(parser<terminal_traits>));
+        }
+
+        TEST_METHOD(should_produce_the_same_tokens_when_instrumented)
+        {
+            string text = "[*] -(a)- [b] / \\ |";
+            _(counting_grammar(text).tokens() == grammar(text).tokens()).should_be_true();
+        }
+
+        TEST_METHOD(should_count_the_chars_ignore_skips)
+        {
+            counting_grammar g("  [*]  ");
+            g.tokens();
+            _(g.instrumentation().ignored_chars).should_be(4u);
+        }
+
+        TEST_METHOD(should_count_the_chars_unignore_gives_back)
+        {
+            counting_grammar g("[a b  ]");
+            g.tokens();
+            _(g.instrumentation().unignores).should_be(1u);
+            _(g.instrumentation().unignored_chars).should_be(2u);
+        }
+
+        TEST_METHOD(should_count_the_spaces_skipped_inside_names_and_edges)
+        {
+            counting_grammar g("[abc   ]-- (x y  )--[b]");
+            g.tokens();
+            auto& stats = g.instrumentation();
+            _(stats.unignored_chars).should_be(5u); // the spaces that end "abc   " and "x y  "
+            _(stats.ignored_chars - stats.unignored_chars).should_be(7u); // every space in the input
+        }
+
+        TEST_METHOD(should_count_a_lookahead_for_each_rewind)
+        {
+            counting_grammar node("[*]");
+            node.tokens();
+            _(node.instrumentation().lookaheads).should_be(1u);
+
+            counting_grammar pipe("|");
+            pipe.tokens();
+            _(pipe.instrumentation().lookaheads).should_be(3u); // past '-' and '\'
+        }
+
+        TEST_METHOD(should_count_tokens_by_type)
+        {
+            counting_grammar g("[*] | [a] -(e)- [b] / \\ (x)");
+            g.tokens();
+            auto& stats = g.instrumentation();
+            _(count_of(stats, token::root_node)).should_be(1u);
+            _(count_of(stats, token::named_node)).should_be(2u);
+            _(count_of(stats, token::horizontal_edge)).should_be(1u);
+            _(count_of(stats, token::edge_name)).should_be(1u);
+            _(count_of(stats, token::ascending_edge_part)).should_be(1u);
+            _(count_of(stats, token::descending_edge_part)).should_be(1u);
+            _(count_of(stats, token::vertical_edge_part)).should_be(1u);
+            _(stats.token_count()).should_be(8u);
+        }
+
+        TEST_METHOD(should_count_the_tokens_of_every_line)
+        {
+            counting_grammar g("[*]\n |\n[a]");
+            g.located_tokens();
+            _(g.instrumentation().token_count()).should_be(3u);
+            _(count_of(g.instrumentation(), token::vertical_edge_part)).should_be(1u);
+        }
+
+        TEST_METHOD(should_count_the_same_in_parallel)
+        {
+            string text;
+            while (text.size() < 512 * 1024) { text += "[*]\n |\n[a] -(e)- [b]\n"; }
+
+            counting_grammar serial(text);
+            serial.located_tokens();
+            counting_grammar parallel(text);
+            parallel.located_tokens_parallel(4);
+
+            auto& expected = serial.instrumentation();
+            auto& actual = parallel.instrumentation();
+            _(actual.tokens == expected.tokens).should_be_true();
+            _(actual.ignored_chars).should_be(expected.ignored_chars);
+            _(actual.lookaheads).should_be(expected.lookaheads);
+        }
+
+        TEST_METHOD(should_time_each_phase)
+        {
+            string text;
+            while (text.size() < 64 * 1024) { text += "[*] -(a)- [b] "; }
+
+            basic_grammar<timing_instrumentation> g(text);
+            g.tokens();
+            auto& stats = g.instrumentation();
+            _(stats.elapsed_in(parse_phase::tokenize).count() > 0).should_be_true();
+            _(stats.elapsed_in(parse_phase::locate).count() == 0).should_be_true();
+            _(stats.elapsed_in(parse_phase::recover).count() == 0).should_be_true();
+            _(stats.token_count()).should_be(g.instrumentation().tokens[token::root_node] * 3);
+        }
+    };
+}}
@@ -0,0 +1,87 @@
+#include "grammar.hpp"
+#include "symbol_table.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_intern_names)
+    {
+    public:
+        TEST_METHOD(should_give_the_empty_name_id_0)
+        {
+            symbol_table symbols;
+            _(symbols.size()).should_be(1u);
+            _(symbols.find("")).should_be(0u);
+            _(symbols.intern("")).should_be(0u);
+        }
+
+        TEST_METHOD(should_give_each_distinct_name_one_id)
+        {
+            symbol_table symbols;
+            auto a = symbols.intern("a");
+            auto b = symbols.intern("b");
+            _(symbols.intern("a")).should_be(a);
+            _(a != b).should_be_true();
+            _(string(symbols.name(b))).should_be("b");
+            _(symbols.find("c")).should_be(symbol_table::npos);
+        }
+
+        TEST_METHOD(should_store_each_name_once_in_one_pool)
+        {
+            symbol_table symbols;
+            for (int i = 0; i < 3; ++i)
+            {
+                symbols.intern("abc");
+                symbols.intern("de");
+            }
+            _(string(symbols.pool())).should_be("abcde");
+        }
+
+        TEST_METHOD(should_keep_ids_as_the_table_grows)
+        {
+            symbol_table symbols;
+            vector<symbol_id> ids;
+            for (int i = 0; i < 1000; ++i) { ids.push_back(symbols.intern("n" + to_string(i))); }
+            for (int i = 0; i < 1000; ++i)
+            {
+                _(symbols.find("n" + to_string(i))).should_be(ids[i]);
+                _(string(symbols.name(ids[i]))).should_be("n" + to_string(i));
+            }
+            _(symbols.size()).should_be(1001u);
+        }
+
+        TEST_METHOD(should_intern_token_names_across_grammars)
+        {
+            symbol_table symbols;
+            auto first = grammar("[*]-(a)-[b]").interned_tokens(symbols);
+            auto second = grammar("[b]-(a)-[c]").interned_tokens(symbols);
+
+            _(first[0] == (interned_token{ token::root_node, 0 })).should_be_true();
+            _(first[1] == second[1]).should_be_true();
+            _(first[2].name).should_be(second[0].name);
+            _(symbols.size()).should_be(4u);
+            _(to_token(second[2], symbols)).should_be(named_node("c"));
+        }
+
+        TEST_METHOD(should_hash_interned_tokens)
+        {
+            symbol_table symbols;
+            auto tokens = grammar("[a] [a] (a) [b]").interned_tokens(symbols);
+            unordered_set<interned_token, interned_token_hash> distinct(tokens.begin(), tokens.end());
+            _(distinct.size()).should_be(3u);
+        }
+
+        TEST_METHOD(should_report_an_error_instead_of_interned_tokens)
+        {
+            symbol_table symbols;
+            auto result = grammar("[a] ]").try_interned_tokens(symbols);
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(4u);
+        }
+    };
+}}
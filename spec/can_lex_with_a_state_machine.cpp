@@ -0,0 +1,88 @@
+#include "dfa_lexer.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_lex_with_a_state_machine)
+    {
+        // the state machine must agree with grammar on every token and every error
+        static void should_match_grammar(const string& s)
+        {
+            auto expected = grammar(string_view(s)).try_token_refs();
+            auto actual = dfa_lexer(s).try_token_refs();
+
+            _(actual.has_value() == expected.has_value()).should_be_true();
+            if (expected)
+            {
+                _(actual.value().size()).should_be(expected.value().size());
+                for (size_t i = 0; i < expected.value().size(); ++i)
+                {
+                    _(actual.value()[i] == expected.value()[i]).should_be_true();
+                }
+            }
+            else
+            {
+                _(actual.error().code == expected.error().code).should_be_true();
+                _(actual.error().pos).should_be(expected.error().pos);
+                _(actual.error().found).should_be(expected.error().found);
+            }
+        }
+
+    public:
+        TEST_METHOD(should_read_the_same_tokens_as_grammar)
+        {
+            for (auto s : {
+                "", "   ", "[*]", "[abc]", "(abc)", "/", "\\", "|", "[*]-(a)-[b]",
+                "[*]--(a)--[b]-(c)-[d]", " [ * ] - - ( a b ) -- [ c d ]  ", "/|\\ (x) [y]",
+                "[*]-(a)-", "[*]-(a)-  ", "[A_z09]  --(_)--  [9]" })
+            {
+                should_match_grammar(s);
+            }
+        }
+
+        TEST_METHOD(should_reject_the_same_input_as_grammar_at_the_same_place)
+        {
+            for (auto s : {
+                "]", "[", "[*", "[* ", "[*x]", "[]", "[a", "[a ", "[a*]", "[a b", "(", "()", "(a",
+                "-", "--", "-(", "-(a", "-(a)", "-(a) ", "-(a)x", "-x", "[*]-(a)-[b!]", "[*]\n", "!",
+                "[*] ) [a]", "[*] -(a) (b)" })
+            {
+                should_match_grammar(s);
+            }
+        }
+
+        TEST_METHOD(should_stop_at_the_same_offsets_as_grammar)
+        {
+            string s = "[*] - (a) -  [b]  /";
+            grammar g{ string_view(s) };
+            dfa_lexer lexer(s);
+            token_ref expected{}, actual{};
+
+            while (g.next(expected))
+            {
+                _(lexer.next(actual)).should_be_true();
+                _(actual == expected).should_be_true();
+                _(lexer.offset()).should_be(g.offset());
+            }
+            _(lexer.next(actual)).should_be_false();
+            _(lexer.failed()).should_be_false();
+        }
+
+        TEST_METHOD(should_make_the_same_tokens_as_grammar)
+        {
+            _(dfa_lexer("[*]-(a)-[b] (c) /").tokens() == grammar("[*]-(a)-[b] (c) /").tokens()).should_be_true();
+        }
+
+        TEST_METHOD(should_throw_like_grammar)
+        {
+            should_throw_(parse_exception("[*]]", 3), []
+            {
+                dfa_lexer("[*]]").tokens();
+            });
+        }
+    };
+}}
@@ -0,0 +1,96 @@
+#include "grammar.hpp"
+#include "test_helpers.hpp"
+#include <string>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_locate_tokens)
+    {
+    public:
+        TEST_METHOD(should_index_the_start_of_every_line)
+        {
+            line_index lines("ab\ncd\r\n\nef");
+            _(lines.rows()).should_be(4u);
+            _(lines.line_begin(1)).should_be(3u);
+            _(string(lines.line(1))).should_be("cd");
+            _(lines.line(2).empty()).should_be_true();
+            _(lines.row_of(8)).should_be(3u);
+        }
+
+        TEST_METHOD(should_locate_tokens_by_row_and_column)
+        {
+            grammar g(
+                "  [*]--(a)--[b]\n"
+                "   |\n"
+                "  (c)  \\\n"
+                "   |    [e f]");
+            auto located = g.located_tokens();
+
+            _(located.size()).should_be(8u);
+            _(located[1].ref.type).should_be(token::horizontal_edge);
+            _(located[1].row).should_be(0u);
+            _(located[1].column).should_be(5u);
+            _(located[1].length).should_be(7u);
+            _(located[3].ref.type).should_be(token::vertical_edge_part);
+            _(located[3].row).should_be(1u);
+            _(located[3].column).should_be(3u);
+            _(located[5].ref.type).should_be(token::descending_edge_part);
+            _(located[5].column).should_be(7u);
+            _(located[7].column).should_be(8u);
+            _(located[7].length).should_be(5u);
+            _(string(g.name(located[7].ref))).should_be("e f");
+        }
+
+        TEST_METHOD(should_ignore_carriage_returns_at_the_end_of_lines)
+        {
+            grammar g("[*]\r\n |\r\n");
+            auto located = g.located_tokens();
+            _(located.size()).should_be(2u);
+            _(located[1].row).should_be(1u);
+        }
+
+        TEST_METHOD(should_locate_the_same_tokens_in_parallel_as_in_one_thread)
+        {
+            string diagram;
+            for (int i = 0; diagram.size() < 1024 * 1024; ++i)
+            {
+                diagram += "[*]--(edge" + to_string(i) + ")--[node" + to_string(i) + "]\n   |    \\\n";
+            }
+
+            grammar g(diagram);
+            auto expected = g.located_tokens();
+            auto actual = g.located_tokens_parallel(4);
+            _(actual.size()).should_be(expected.size());
+            _(actual == expected).should_be_true();
+        }
+
+        TEST_METHOD(should_report_the_first_error_when_locating_tokens_in_parallel)
+        {
+            string diagram;
+            while (diagram.size() < 1024 * 1024) { diagram += "[*]--(a)--[b]\n"; }
+            size_t first_error = diagram.size() / 3;
+            diagram[first_error] = '!';
+            diagram[diagram.size() - 2] = '!';
+
+            try
+            {
+                grammar(std::move(diagram)).located_tokens_parallel(4);
+                Microsoft::VisualStudio::CppUnitTestFramework::Assert::Fail(L"Should have thrown");
+            }
+            catch (parse_exception& e)
+            {
+                _(e.pos).should_be(first_error);
+            }
+        }
+
+        TEST_METHOD(should_report_an_error_at_its_offset_in_the_whole_input)
+        {
+            should_throw_(parse_exception("[*]\n ]", 5), []
+            {
+                grammar("[*]\n ]").located_tokens();
+            });
+        }
+    };
+}}
@@ -0,0 +1,64 @@
+#include "batch.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_parse_batches)
+    {
+    public:
+        TEST_METHOD(should_return_no_results_for_an_empty_batch)
+        {
+            batch_parser batch(2);
+            _(batch.parse(vector<string>()).empty()).should_be_true();
+        }
+
+        TEST_METHOD(should_return_the_tokens_of_every_input_in_order)
+        {
+            vector<string> inputs;
+            for (int i = 0; i < 1000; ++i)
+            {
+                inputs.push_back("[*]-(e" + to_string(i) + ")-[n" + to_string(i) + "]");
+            }
+
+            batch_parser batch(4);
+            auto results = batch.parse(inputs);
+
+            _(results.size()).should_be(inputs.size());
+            for (size_t i = 0; i < inputs.size(); ++i)
+            {
+                _(results[i].has_value()).should_be_true();
+                _(results[i].value()).should_equal({ root_node(),
+                    horizontal_edge("e" + to_string(i)), named_node("n" + to_string(i)) });
+            }
+        }
+
+        TEST_METHOD(should_report_an_error_for_each_invalid_input)
+        {
+            vector<string_view> inputs = { "[*]", "[*]]", "|", "[!]" };
+            batch_parser batch(3);
+            auto results = batch.parse(inputs);
+
+            _(results[0].has_value()).should_be_true();
+            _(results[1].has_value()).should_be_false();
+            _(results[1].error().pos).should_be(3u);
+            _(results[2].has_value()).should_be_true();
+            _(results[3].has_value()).should_be_false();
+            _(results[3].error().pos).should_be(1u);
+        }
+
+        TEST_METHOD(should_reuse_its_workers_across_batches)
+        {
+            batch_parser batch(2);
+            for (int i = 0; i < 50; ++i)
+            {
+                auto results = batch.parse(vector<string>{ "[a]", "\\\\", "/" });
+                _(results.size()).should_be(3u);
+                _(results[2].value()).should_equal({ ascending_edge_part() });
+            }
+        }
+    };
+}}
@@ -38,6 +38,24 @@ namespace ascii_tree { namespace spec
             _(copy.at_end()).should_be_true();
         }
 
+        TEST_METHOD(a_parser_should_read_borrowed_chars_in_place)
+        {
+            string test_str = "12";
+            test_parser p(string_view(test_str), 1);
+            test_str[1] = '1';          // the parser sees the caller's buffer, not a copy
+            p.expect(one);
+            _(p.at_end()).should_be_true();
+        }
+
+        TEST_METHOD(a_parser_should_take_ownership_of_a_moved_string)
+        {
+            string test_str = "12";
+            test_parser p(std::move(test_str));
+            p.expect(one);
+            p.expect(two);
+            _(p.at_end()).should_be_true();
+        }
+
         TEST_METHOD(ignore_should_not_advance_the_parser_on_an_empty_string)
         {
             test_parser p("");
@@ -97,6 +115,21 @@ namespace ascii_tree { namespace spec
             _(p.accept(one)).should_be_true();
         }
 
+        TEST_METHOD(accept_all_should_consume_a_run_of_a_terminal_and_ignored_chars)
+        {
+            test_parser p("1131332");
+            p.accept_all(one);
+            p.expect(two);
+            _(p.at_end()).should_be_true();
+        }
+
+        TEST_METHOD(accept_all_should_not_advance_the_parser_when_the_terminal_does_not_match)
+        {
+            test_parser p("2");
+            p.accept_all(one);
+            _(p.at_begin()).should_be_true();
+        }
+
         TEST_METHOD(expect_should_not_throw_when_a_terminal_matches_the_expected_value)
         {
             should_not_throw_([]
@@ -113,6 +146,33 @@ namespace ascii_tree { namespace spec
             });
         }
 
+        TEST_METHOD(check_should_record_an_error_instead_of_throwing)
+        {
+            test_parser p("3312");
+            p.check(two);
+            _(p.failed()).should_be_true();
+            _(p.error_offset()).should_be(2u);
+        }
+
+        TEST_METHOD(a_failed_parser_should_not_accept_anything_else)
+        {
+            test_parser p("12");
+            p.check(two);
+            _(p.accept(one)).should_be_false();
+            p.check(one);
+            _(p.error_offset()).should_be(0u);
+        }
+
+        TEST_METHOD(expect_should_throw_at_the_recorded_error)
+        {
+            should_throw_(parse_exception("312", 1), []
+            {
+                test_parser p("312");
+                p.check(two);
+                p.expect(one);
+            });
+        }
+
         TEST_METHOD(substring_should_return_the_chars_from_the_given_position_to_the_current_position)
         {
             test_parser p("1212", 1);   // position is here: "1>212"
@@ -0,0 +1,99 @@
+#include "tree.hpp"
+#include "test_helpers.hpp"
+#include <memory_resource>
+#include <string>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    // forwards to new/delete and counts what passes through
+    class counting_resource : public pmr::memory_resource
+    {
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            ++deallocations;
+            pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    public:
+        size_t allocations = 0;
+        size_t deallocations = 0;
+    };
+
+    TEST_CLASS(can_parse_into_memory_resources)
+    {
+    public:
+        TEST_METHOD(should_copy_the_input_into_the_resource)
+        {
+            counting_resource resource;
+            {
+                grammar g("[*]-(a)-[b]", &resource);
+                _(resource.allocations).should_be(1u); // string and control block together
+                _(g.tokens().size()).should_be(3u);
+            }
+            _(resource.deallocations).should_be(1u);
+        }
+
+        TEST_METHOD(should_copy_a_long_input_into_the_resource_too)
+        {
+            string text = "[*]";
+            while (text.size() < 1000) { text += "-(a)-[b]"; }
+
+            counting_resource resource;
+            {
+                grammar g(text, &resource);
+                _(resource.allocations).should_be(2u); // the chars no longer fit in the string itself
+                _(g.tokens().size()).should_be(1u + 2 * (text.size() - 3) / 8);
+            }
+            _(resource.deallocations).should_be(2u);
+        }
+
+        TEST_METHOD(should_put_token_refs_in_the_resource)
+        {
+            counting_resource resource;
+            grammar g("[*]-(a)-[b]");
+            auto refs = g.token_refs(&resource);
+            _(refs.size()).should_be(3u);
+            _(resource.allocations > 0).should_be_true();
+        }
+
+        TEST_METHOD(should_put_tokens_in_the_resource_in_one_allocation)
+        {
+            counting_resource resource;
+            grammar g("[*]-(a)-[b]");
+            auto tokens = g.tokens(&resource);
+            _(tokens.size()).should_be(3u);
+            _(tokens[1] == horizontal_edge("a")).should_be_true();
+            _(resource.allocations).should_be(1u); // reserved up front, never grown
+        }
+
+        TEST_METHOD(should_parse_everything_inside_a_fixed_arena)
+        {
+            char buffer[16 * 1024];
+            pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), pmr::null_memory_resource());
+
+            grammar g(
+                "[*]--(a)--[b]\n"
+                " |\n"
+                "[c]", &arena);
+            auto located = g.located_tokens(&arena);
+            tree t(g, &arena);
+
+            _(located.size()).should_be(5u);
+            _(t.size()).should_be(3u);
+            _(string(t.name(2))).should_be("c");
+        }
+    };
+}}
@@ -0,0 +1,128 @@
+#include "box_drawing.hpp"
+#include "grammar.hpp"
+#include "incremental.hpp"
+#include "stream.hpp"
+#include "tree.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_read_box_drawing_chars)
+    {
+        // U+2502, U+251C, U+2514 and U+2500 in UTF-8
+        const string vertical = "\xE2\x94\x82";
+        const string vertical_and_right = "\xE2\x94\x9C";
+        const string up_and_right = "\xE2\x94\x94";
+        const string horizontal = "\xE2\x94\x80";
+
+    public:
+        TEST_METHOD(should_tell_ascii_from_utf8_in_any_block)
+        {
+            _(is_ascii("")).should_be_true();
+            _(is_ascii(string(100, '-'))).should_be_true();
+            for (size_t at : { 0u, 15u, 16u, 31u, 32u, 40u, 99u })
+            {
+                string text(100, ' ');
+                text[at] = '\xC3';
+                _(is_ascii(text)).should_be_false();
+            }
+        }
+
+        TEST_METHOD(should_turn_each_box_drawing_char_into_one_ascii_char)
+        {
+            auto ascii = ascii_from_box_drawing(vertical + vertical_and_right + up_and_right + horizontal + "[a]");
+            _(ascii).should_be("||\\-[a]");
+        }
+
+        TEST_METHOD(should_copy_other_bytes_as_they_are)
+        {
+            _(ascii_from_box_drawing("[a]\xC3\xA9")).should_be("[a]\xC3\xA9");
+            _(ascii_from_box_drawing("\xE2\x94")).should_be("\xE2\x94");
+        }
+
+        TEST_METHOD(should_tokenize_box_drawing_chars_as_their_ascii_chars)
+        {
+            auto box = "[*]" + horizontal + horizontal + "(a)" + horizontal + "[b] " + vertical + " " +
+                vertical_and_right + " " + up_and_right;
+            _(grammar::from_box_drawing(box).tokens() == grammar("[*]--(a)-[b] | | \\").tokens()).should_be_true();
+        }
+
+        TEST_METHOD(should_count_a_box_drawing_char_as_one_column)
+        {
+            auto box = "[a]" + horizontal + "(e)" + horizontal + "[b]\n " + vertical + "\n[c]";
+            _(grammar::from_box_drawing(box).located_tokens() == grammar("[a]-(e)-[b]\n |\n[c]").located_tokens()).should_be_true();
+        }
+
+        TEST_METHOD(should_build_a_tree_from_box_drawing_chars)
+        {
+            auto g = grammar::from_box_drawing("[*]\n " + vertical + "\n[a]\n   " + up_and_right + "\n    [b]");
+            tree t(g);
+            _(t.size()).should_be(3u);
+            _(string(t.name(t.children(t.root()).begin()[0]))).should_be("a");
+        }
+
+        TEST_METHOD(should_report_errors_in_the_ascii_copy)
+        {
+            auto result = grammar::from_box_drawing(horizontal + "(a)" + horizontal + "\xC3\xA9").try_tokens();
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(5u);
+            _(result.error().found == none).should_be_true();
+        }
+
+        TEST_METHOD(should_read_box_drawing_chars_as_they_are_unless_asked)
+        {
+            string box = "[*]" + horizontal + "(a)" + horizontal + "[b]";
+            auto result = grammar(string_view(box)).try_tokens();
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(3u);
+            _(result.error().found == none).should_be_true();
+        }
+
+        TEST_METHOD(should_not_read_a_branch_without_an_edge_name_as_an_edge)
+        {
+            auto result = grammar::from_box_drawing(vertical_and_right + horizontal + horizontal + "[a]").try_tokens();
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(3u);
+            _(result.error().found == open_square_brace).should_be_true();
+        }
+
+        TEST_METHOD(should_find_a_utf8_sequence_cut_short)
+        {
+            _(incomplete_utf8_suffix("")).should_be(0u);
+            _(incomplete_utf8_suffix("abc")).should_be(0u);
+            _(incomplete_utf8_suffix("a\xE2")).should_be(1u);
+            _(incomplete_utf8_suffix("a\xE2\x94")).should_be(2u);
+            _(incomplete_utf8_suffix("a" + horizontal)).should_be(0u);
+            _(incomplete_utf8_suffix("a\xC3")).should_be(1u);
+        }
+
+        TEST_METHOD(should_stream_box_drawing_chars_split_across_chunks)
+        {
+            auto box = "[*]" + horizontal + "(a)" + horizontal + horizontal + "[b]";
+            vector<token> tokens;
+            stream_tokenizer tokenizer;
+            for (char ch : box)
+            {
+                tokenizer.feed(string_view(&ch, 1), [&](token&& tok) { tokens.push_back(std::move(tok)); });
+            }
+            tokenizer.finish([&](token&& tok) { tokens.push_back(std::move(tok)); });
+
+            _(tokens == grammar("[*]-(a)--[b]").tokens()).should_be_true();
+            _(tokenizer.offset()).should_be(12u);
+        }
+
+        TEST_METHOD(should_retokenize_box_drawing_chars_like_a_full_parse)
+        {
+            auto box = "[a]" + horizontal + "(e)" + horizontal + "[b]\n " + vertical + "\n[c]";
+            incremental_tokenizer tokenizer(box);
+            _(tokenizer.located_tokens() == grammar::from_box_drawing(tokenizer.text()).located_tokens()).should_be_true();
+
+            tokenizer.apply(text_edit{ 0, 0, vertical_and_right + " " });
+            _(tokenizer.located_tokens() == grammar::from_box_drawing(tokenizer.text()).located_tokens()).should_be_true();
+        }
+    };
+}}
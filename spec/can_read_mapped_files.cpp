@@ -0,0 +1,45 @@
+#include "mapped_file.hpp"
+#include "test_helpers.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_read_mapped_files)
+    {
+        static string write_temp_file(const char* name, const string& contents)
+        {
+            auto path = (filesystem::temp_directory_path() / name).string();
+            ofstream(path, ios::binary) << contents;
+            return path;
+        }
+
+    public:
+        TEST_METHOD(should_recognize_tokens_in_a_mapped_file)
+        {
+            auto path = write_temp_file("ascii_tree_mapped.txt", "[*]-(a)-[b]");
+            auto tokens = grammar_from_file(path).tokens();
+            filesystem::remove(path);
+            _(tokens).should_equal({ root_node(), horizontal_edge("a"), named_node("b") });
+        }
+
+        TEST_METHOD(should_not_recognize_any_tokens_in_an_empty_file)
+        {
+            auto path = write_temp_file("ascii_tree_mapped_empty.txt", "");
+            auto tokens = grammar_from_file(path).tokens();
+            filesystem::remove(path);
+            _(tokens).should_be_empty();
+        }
+
+        TEST_METHOD(should_throw_when_the_file_does_not_exist)
+        {
+            Microsoft::VisualStudio::CppUnitTestFramework::Assert::ExpectException<system_error>([]
+            {
+                grammar_from_file((filesystem::temp_directory_path() / "ascii_tree_no_such_file.txt").string());
+            });
+        }
+    };
+}}
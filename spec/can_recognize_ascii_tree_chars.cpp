@@ -90,5 +90,26 @@ namespace ascii_tree { namespace spec
             _(term).should_be(none);
         }
 
+        TEST_METHOD(should_not_recognize_a_non_ascii_char_as_a_name_char)
+        {
+            terminal term = terminal_traits::to_terminal('\xE9');
+            _(term).should_be(none);
+        }
+
+        TEST_METHOD(should_look_up_the_same_terminal_that_classify_computes)
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                char ch = static_cast<char>(i);
+                _(terminal_traits::to_terminal(ch)).should_be(terminal_traits::classify(ch));
+            }
+        }
+
+        TEST_METHOD(should_classify_chars_at_compile_time)
+        {
+            static_assert(terminal_traits::to_terminal('[') == open_square_brace, "");
+            static_assert(terminal_traits::to_terminal('\n') == none, "");
+        }
+
     };
 }}
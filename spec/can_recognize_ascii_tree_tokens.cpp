@@ -1,5 +1,8 @@
 #include "grammar.hpp"
 #include "test_helpers.hpp"
+#include <deque>
+#include <iterator>
+#include <vector>
 
 using namespace std;
 
@@ -78,6 +81,59 @@ namespace ascii_tree { namespace spec
             });
         }
 
+        TEST_METHOD(should_recognize_tokens_in_borrowed_chars)
+        {
+            string test_str = "[*]-(a)-[b]";
+            auto tokens = grammar(string_view(test_str)).tokens();
+            _(tokens).should_equal({ root_node(), horizontal_edge("a"), named_node("b") });
+        }
+
+        TEST_METHOD(should_refer_to_names_as_spans_of_the_input)
+        {
+            grammar g("[*]-(ab)-[ c d ]");
+            auto refs = g.token_refs();
+            _(refs.size()).should_be(3u);
+            _(refs[1].type).should_be(token::horizontal_edge);
+            _(refs[1].offset).should_be(5u);
+            _(string(g.name(refs[1]))).should_be("ab");
+            _(string(g.name(refs[2]))).should_be("c d");
+        }
+
+        TEST_METHOD(should_give_unnamed_token_refs_an_empty_name_at_the_start_of_the_token)
+        {
+            grammar g(" [*] |");
+            auto refs = g.token_refs();
+            _(refs[0].offset).should_be(1u);
+            _(refs[1].offset).should_be(5u);
+            _(g.name(refs[1]).empty()).should_be_true();
+        }
+
+        TEST_METHOD(should_read_lazy_tokens_in_order)
+        {
+            grammar g("[*]-(a)-[b] | (c)");
+            vector<token> tokens(g.lazy_tokens().begin(), g.lazy_tokens().end());
+            _(tokens).should_equal({ root_node(), horizontal_edge("a"), named_node("b"), vertical_edge_part(), edge_name("c") });
+        }
+
+        TEST_METHOD(should_not_read_past_the_last_lazy_token_taken)
+        {
+            grammar g("[*] [a] ]]]");
+            auto it = g.lazy_tokens().begin();
+            _(*it).should_be(root_node());
+            ++it;
+            _(*it).should_be(named_node("a"));
+        }
+
+        TEST_METHOD(should_throw_when_a_lazy_token_is_invalid)
+        {
+            should_throw_(parse_exception("[*] ]", 4), []
+            {
+                grammar g("[*] ]");
+                auto it = g.lazy_tokens().begin();
+                ++it;
+            });
+        }
+
         TEST_METHOD(should_recognize_a_root_node_next_to_a_named_node)
         {
             auto tokens = grammar("[*][a]").tokens();
@@ -312,5 +368,42 @@ namespace ascii_tree { namespace spec
             _(tokens).should_equal({ edge_name("a"), edge_name("b") });
         }
 
+        TEST_METHOD(should_estimate_the_token_count_of_valid_input_exactly)
+        {
+            _(grammar("").estimate_token_count()).should_be(0u);
+            _(grammar("[*]--(a)--[b] (c) / \\ |").estimate_token_count()).should_be(7u);
+            _(estimate_token_count("[[[")).should_be(3u); // invalid input may count high
+        }
+
+        TEST_METHOD(should_append_tokens_to_a_caller_container)
+        {
+            vector<token> tokens;
+            tokens.push_back(root_node());
+            auto count = grammar("[a]|").append_tokens(tokens);
+            _(count).should_be(2u);
+            _(tokens).should_equal({ root_node(), named_node("a"), vertical_edge_part() });
+
+            tokens.clear();
+            auto capacity = tokens.capacity();
+            grammar("[b]").append_tokens(tokens);
+            _(tokens.capacity()).should_be(capacity); // reused, not reallocated
+        }
+
+        TEST_METHOD(should_write_tokens_to_an_output_iterator)
+        {
+            deque<token> tokens;
+            grammar("[*]-(a)-[b]").tokens_into(back_inserter(tokens));
+            _(tokens.size()).should_be(3u);
+            _(tokens.back() == named_node("b")).should_be_true();
+        }
+
+        TEST_METHOD(should_keep_the_tokens_before_an_error_when_appending)
+        {
+            vector<token> tokens;
+            auto result = grammar("[a] ]").try_append_tokens(tokens);
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(4u);
+            _(tokens).should_equal({ named_node("a") });
+        }
     };
 }}
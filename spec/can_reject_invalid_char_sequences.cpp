@@ -73,5 +73,88 @@ namespace ascii_tree { namespace spec
             });
         }
 
+        TEST_METHOD(should_return_an_error_instead_of_throwing)
+        {
+            should_not_throw_([]
+            {
+                auto result = grammar("[*]]").try_tokens();
+                _(result.has_value()).should_be_false();
+                _(result.error().code == parse_errc::unexpected_char).should_be_true();
+                _(result.error().pos).should_be(3u);
+                _(result.error().found).should_be(close_square_brace);
+            });
+        }
+
+        TEST_METHOD(should_return_an_error_at_the_end_of_an_unfinished_token)
+        {
+            auto result = grammar("[*]-(a)").try_token_refs();
+            _(result.has_value()).should_be_false();
+            _(result.error().code == parse_errc::unexpected_end).should_be_true();
+            _(result.error().pos).should_be(7u);
+            _(result.error().found).should_be(none);
+        }
+
+        TEST_METHOD(should_return_the_tokens_when_there_is_no_error)
+        {
+            auto result = grammar("[*]-(a)-[b]").try_tokens();
+            _(result.has_value()).should_be_true();
+            _(result.value()).should_equal({ root_node(), horizontal_edge("a"), named_node("b") });
+        }
+
+        TEST_METHOD(should_return_an_error_at_its_offset_in_a_multi_line_input)
+        {
+            auto result = grammar("[*]\n |\n [!]").try_located_tokens();
+            _(result.has_value()).should_be_false();
+            _(result.error().pos).should_be(9u);
+        }
+
+        TEST_METHOD(should_stop_reading_tokens_at_an_error_when_asked_not_to_throw)
+        {
+            grammar g("[a] ] [b]");
+            token_ref ref{};
+            _(g.next(ref)).should_be_true();
+            _(g.next(ref)).should_be_false();
+            _(g.failed()).should_be_true();
+            _(g.error().pos).should_be(4u);
+        }
+
+        TEST_METHOD(should_collect_every_error_and_the_tokens_between_them)
+        {
+            auto result = grammar("[a] ] [b] [c]]").recover_tokens();
+            _(result.tokens).should_equal({ named_node("a"), named_node("b"), named_node("c") });
+            _(result.errors.size()).should_be(2u);
+            _(result.errors[0].pos).should_be(4u);
+            _(result.errors[0].found).should_be(close_square_brace);
+            _(result.errors[1].pos).should_be(13u);
+        }
+
+        TEST_METHOD(should_resume_after_a_broken_token_at_the_next_token_start)
+        {
+            auto result = grammar("[ab!] [c]").recover_tokens();
+            _(result.tokens).should_equal({ named_node("c") });
+            _(result.errors.size()).should_be(1u);
+            _(result.errors[0].pos).should_be(3u);
+        }
+
+        TEST_METHOD(should_stop_recovering_at_an_unfinished_token)
+        {
+            auto result = grammar("[a] [b").recover_tokens();
+            _(result.tokens).should_equal({ named_node("a") });
+            _(result.errors.size()).should_be(1u);
+            _(result.errors[0].code == parse_errc::unexpected_end).should_be_true();
+            _(result.errors[0].pos).should_be(6u);
+        }
+
+        TEST_METHOD(should_collect_errors_from_every_line_at_their_offsets)
+        {
+            auto result = grammar("[a] ]\n |\n [!]").recover_located_tokens();
+            _(result.tokens.size()).should_be(2u);
+            _(result.tokens[1].row).should_be(1u);
+            _(result.tokens[1].column).should_be(1u);
+            _(result.errors.size()).should_be(2u);
+            _(result.errors[0].pos).should_be(4u);
+            _(result.errors[1].pos).should_be(11u);
+        }
+
     };
 }}
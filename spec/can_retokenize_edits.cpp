@@ -0,0 +1,142 @@
+#include "incremental.hpp"
+#include "test_helpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_retokenize_edits)
+    {
+        static const char* diagram()
+        {
+            return
+                "     [*]\n"
+                "    / | \\\n"
+                " [a] (x) [c]\n"
+                "      |\n"
+                "     [b]\n";
+        }
+
+        // after any edit the tokens must be what a full re-parse would give
+        static void should_match_a_full_parse(const incremental_tokenizer& tokens)
+        {
+            auto text = tokens.text();
+            auto expected = grammar(text).try_located_tokens();
+            auto actual = tokens.try_located_tokens();
+
+            _(actual.has_value() == expected.has_value()).should_be_true();
+            if (expected)
+            {
+                _(actual.value() == expected.value()).should_be_true();
+            }
+            else
+            {
+                _(actual.error().pos).should_be(expected.error().pos);
+            }
+        }
+
+    public:
+        TEST_METHOD(should_tokenize_like_grammar_before_any_edit)
+        {
+            incremental_tokenizer tokens(diagram());
+            _(tokens.text()).should_be(diagram());
+            should_match_a_full_parse(tokens);
+        }
+
+        TEST_METHOD(should_relex_only_the_edited_line)
+        {
+            incremental_tokenizer tokens(diagram());
+            _(tokens.apply(text_edit{ 21, 1, "abc" }).count).should_be(1u);
+            _(string(tokens.line(2))).should_be(" [abc] (x) [c]");
+            should_match_a_full_parse(tokens);
+        }
+
+        TEST_METHOD(should_relex_the_lines_an_edit_spans_as_one)
+        {
+            incremental_tokenizer tokens(diagram());
+            _(tokens.apply(text_edit{ 19, 20, "" }).count).should_be(1u);
+            _(tokens.rows()).should_be(5u);
+            _(tokens.line(2).empty()).should_be_true();
+            _(string(tokens.line(3))).should_be("     [b]");
+            should_match_a_full_parse(tokens);
+        }
+
+        TEST_METHOD(should_relex_each_line_an_edit_inserts)
+        {
+            incremental_tokenizer tokens("[*]\n |\n[a]");
+            _(tokens.apply(text_edit{ 10, 0, "\n |\n[b]" }).count).should_be(3u);
+            _(tokens.text()).should_be("[*]\n |\n[a]\n |\n[b]");
+            should_match_a_full_parse(tokens);
+        }
+
+        TEST_METHOD(should_report_an_error_an_edit_introduces_and_forget_it_once_fixed)
+        {
+            incremental_tokenizer tokens(diagram());
+            tokens.apply(text_edit{ 19, 0, "!" });
+            _(tokens.failed()).should_be_true();
+            _(tokens.error().pos).should_be(19u);
+            should_match_a_full_parse(tokens);
+
+            tokens.apply(text_edit{ 19, 1, "" });
+            _(tokens.failed()).should_be_false();
+            _(tokens.text()).should_be(diagram());
+            should_match_a_full_parse(tokens);
+        }
+
+        TEST_METHOD(should_return_the_first_row_it_relexed)
+        {
+            incremental_tokenizer tokens(diagram());
+            auto rows = tokens.apply(text_edit{ 37, 0, "\n" });
+            _(rows.first).should_be(3u);
+            _(rows.count).should_be(2u);
+            should_match_a_full_parse(tokens);
+        }
+
+        TEST_METHOD(should_give_each_row_its_own_result_and_offset)
+        {
+            incremental_tokenizer tokens("[*]\n |\n[!]\n[a]");
+            _(tokens.row_offset(2)).should_be(7u);
+            _(tokens.row_result(1).has_value()).should_be_true();
+            _(tokens.row_result(2).has_value()).should_be_false();
+            _(tokens.row_result(2).error().pos).should_be(1u);
+            _(tokens.row_result(3).value().size()).should_be(1u);
+            _(tokens.error().pos).should_be(8u);
+        }
+
+        TEST_METHOD(should_find_rows_and_errors_after_many_edits)
+        {
+            string text;
+            for (int i = 0; i < 100; ++i) { text += "[*]-(a)-[b]\n"; }
+            incremental_tokenizer tokens(text);
+
+            for (size_t row = 0; row < 100; row += 7)
+            {
+                tokens.apply(text_edit{ row * 12 + 5, 1, "!" });
+                should_match_a_full_parse(tokens);
+            }
+            for (size_t row = 0; row < 100; row += 7)
+            {
+                tokens.apply(text_edit{ row * 12 + 5, 1, "a" });
+                should_match_a_full_parse(tokens);
+            }
+            _(tokens.failed()).should_be_false();
+
+            tokens.apply(text_edit{ 600, 0, "\n(!\n" });
+            should_match_a_full_parse(tokens);
+            _(tokens.error().pos).should_be(602u);
+            tokens.apply(text_edit{ 600, 4, "" });
+            should_match_a_full_parse(tokens);
+            _(tokens.text()).should_be(text);
+        }
+
+        TEST_METHOD(should_apply_an_edit_at_the_end)
+        {
+            incremental_tokenizer tokens("[*]");
+            _(tokens.apply(text_edit{ 3, 0, "-(a)-[b]" }).count).should_be(1u);
+            _(tokens.row_tokens(0).size()).should_be(3u);
+            should_match_a_full_parse(tokens);
+        }
+    };
+}}
@@ -0,0 +1,77 @@
+#include "scan.hpp"
+#include "test_helpers.hpp"
+#include <string>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_scan_runs)
+    {
+        // a run of the given length followed by a stop char, so every block
+        // size and tail length the scanners handle gets exercised
+        template<typename Fn>
+        static void should_stop_after_runs_of_every_length(const string& run_chars, char stop, Fn scan)
+        {
+            for (size_t len = 0; len < 100; ++len)
+            {
+                string s;
+                for (size_t i = 0; i < len; ++i) { s += run_chars[i % run_chars.size()]; }
+                s += stop;
+                s += run_chars;
+
+                const char* end = scan(s.data(), s.data() + s.size());
+                _(static_cast<size_t>(end - s.data())).should_be(len);
+            }
+        }
+
+    public:
+        TEST_METHOD(should_not_advance_over_an_empty_range)
+        {
+            const char* s = "";
+            _(scan::skip_char(s, s, ' ') == s).should_be_true();
+        }
+
+        TEST_METHOD(should_skip_a_run_of_one_char)
+        {
+            should_stop_after_runs_of_every_length(" ", '[', [](const char* first, const char* last)
+            {
+                return scan::skip_char(first, last, ' ');
+            });
+        }
+
+        TEST_METHOD(should_skip_a_run_of_either_char)
+        {
+            should_stop_after_runs_of_every_length("-- -", '(', [](const char* first, const char* last)
+            {
+                return scan::skip_either_char(first, last, '-', ' ');
+            });
+        }
+
+        TEST_METHOD(should_skip_a_run_of_name_chars)
+        {
+            should_stop_after_runs_of_every_length("azAZ09_ ", ']', [](const char* first, const char* last)
+            {
+                return scan::skip_name_chars_or(first, last, ' ');
+            });
+        }
+
+        TEST_METHOD(should_not_skip_chars_next_to_the_name_char_ranges)
+        {
+            for (char ch : string("@[`{/:^\x7f\x80\xE9"))
+            {
+                should_stop_after_runs_of_every_length("aZ", ch, [](const char* first, const char* last)
+                {
+                    return scan::skip_name_chars_or(first, last, ' ');
+                });
+            }
+        }
+
+        TEST_METHOD(should_stop_at_the_end_of_a_range_that_is_all_run)
+        {
+            string s(70, '-');
+            const char* end = scan::skip_either_char(s.data(), s.data() + s.size(), '-', ' ');
+            _(end == s.data() + s.size()).should_be_true();
+        }
+    };
+}}
@@ -0,0 +1,162 @@
+#include "binary.hpp"
+#include "binary_file.hpp"
+#include "test_helpers.hpp"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_serialize_binaries)
+    {
+        static const char* diagram()
+        {
+            return
+                "     [*]\n"
+                "    / | \\\n"
+                " [a] (x) [c]\n"
+                "      |\n"
+                "     [a]\n";
+        }
+
+        static vector<token> tokens_of(grammar& g)
+        {
+            vector<token> tokens;
+            for (auto& located : g.located_tokens()) { tokens.push_back(g.to_token(located.ref)); }
+            return tokens;
+        }
+
+        static string overwrite(string image, uint64_t at, uint64_t value)
+        {
+            memcpy(&image[at], &value, sizeof(value));
+            return image;
+        }
+
+    public:
+        TEST_METHOD(should_read_back_the_tokens_it_wrote)
+        {
+            auto tokens = grammar("[*]-(a)-[b] (a) / | \\").tokens();
+            auto image = binary_writer(tokens).write();
+
+            binary_image read(image);
+            _(read.valid()).should_be_true();
+            _(read.tokens() == tokens).should_be_true();
+            _(read.empty()).should_be_true();
+        }
+
+        TEST_METHOD(should_read_back_the_tree_it_wrote)
+        {
+            grammar g(diagram());
+            auto tokens = tokens_of(g);
+            tree t(g);
+            auto image = binary_writer(tokens, t).write();
+
+            binary_image read(image);
+            _(read.valid()).should_be_true();
+            _(read.tokens() == tokens).should_be_true();
+            _(read.size()).should_be(t.size());
+            _(read.root()).should_be(t.root());
+            for (size_t node = 0; node < t.size(); ++node)
+            {
+                _(read.parent(node)).should_be(t.parent(node));
+                _(string(read.node_name(node))).should_be(string(t.name(node)));
+                _(string(read.edge_name(node))).should_be(string(t.edge_name(node)));
+                _(vector<size_t>(read.children(node).begin(), read.children(node).end()) ==
+                    vector<size_t>(t.children(node).begin(), t.children(node).end())).should_be_true();
+            }
+        }
+
+        TEST_METHOD(should_store_each_name_once)
+        {
+            auto image = binary_writer(grammar("[abc]-(abc)-[abc]").tokens()).write();
+            _(image.find("abc") == image.rfind("abc")).should_be_true();
+        }
+
+        TEST_METHOD(should_not_read_anything_else)
+        {
+            _(binary_image("").valid()).should_be_false();
+
+            auto image = binary_writer(grammar("[*]").tokens()).write();
+            auto wrong_version = image;
+            wrong_version[8] = 2;
+            _(binary_image(wrong_version).valid()).should_be_false();
+
+            auto truncated = image.substr(0, image.size() - 1);
+            _(binary_image(truncated).valid()).should_be_false();
+        }
+
+        TEST_METHOD(should_find_every_node_and_token_in_range_in_what_it_wrote)
+        {
+            grammar g(diagram());
+            auto tokens = tokens_of(g);
+            tree t(g);
+            _(binary_image(binary_writer(tokens, t).write()).well_formed()).should_be_true();
+            _(binary_image(binary_writer(tokens).write()).well_formed()).should_be_true();
+        }
+
+        TEST_METHOD(should_find_a_node_or_token_out_of_range)
+        {
+            grammar g(diagram());
+            auto tokens = tokens_of(g);
+            tree t(g);
+            auto image = binary_writer(tokens, t).write();
+            binary_format::layout at(tokens.size(), t.size(), 0);
+            uint64_t nodes = t.size();
+
+            _(binary_image(overwrite(image, at.children, nodes)).well_formed()).should_be_false();
+            _(binary_image(overwrite(image, at.child_begin + 8, nodes + 1)).well_formed()).should_be_false();
+            _(binary_image(overwrite(image, at.parents + 8, nodes)).well_formed()).should_be_false();
+            _(binary_image(overwrite(image, offsetof(binary_format::header, root), nodes)).well_formed()).should_be_false();
+
+            auto bad_type = image;
+            bad_type[at.token_types] = 7;
+            _(binary_image(bad_type).well_formed()).should_be_false();
+        }
+
+        TEST_METHOD(should_map_a_saved_image)
+        {
+            grammar g(diagram());
+            auto tokens = tokens_of(g);
+            tree t(g);
+            auto path = (filesystem::temp_directory_path() / "ascii_tree_binary.bin").string();
+            save_binary(path, binary_writer(tokens, t).write());
+
+            {
+                binary_file file(path);
+                _(file.image().tokens() == tokens).should_be_true();
+                _(file.image().size()).should_be(t.size());
+            }
+            filesystem::remove(path);
+        }
+
+        TEST_METHOD(should_refuse_to_map_a_file_that_is_not_an_image)
+        {
+            auto path = (filesystem::temp_directory_path() / "ascii_tree_not_binary.bin").string();
+            save_binary(path, "[*]-(a)-[b]");
+            Microsoft::VisualStudio::CppUnitTestFramework::Assert::ExpectException<binary_format_error>([&]
+            {
+                binary_file file(path);
+            });
+            filesystem::remove(path);
+        }
+
+        TEST_METHOD(should_refuse_to_map_a_corrupt_image)
+        {
+            grammar g(diagram());
+            auto tokens = tokens_of(g);
+            tree t(g);
+            binary_format::layout at(tokens.size(), t.size(), 0);
+            auto path = (filesystem::temp_directory_path() / "ascii_tree_corrupt.bin").string();
+            save_binary(path, overwrite(binary_writer(tokens, t).write(), at.children, 1000));
+            Microsoft::VisualStudio::CppUnitTestFramework::Assert::ExpectException<binary_format_error>([&]
+            {
+                binary_file file(path);
+            });
+            filesystem::remove(path);
+        }
+    };
+}}
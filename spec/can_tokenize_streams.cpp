@@ -0,0 +1,144 @@
+#include "stream.hpp"
+#include "test_helpers.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace ascii_tree { namespace spec
+{
+    TEST_CLASS(can_tokenize_streams)
+    {
+        static vector<token> tokenize_in_chunks(const string& s, size_t split)
+        {
+            vector<token> tokens;
+            auto emit = [&](token&& tok) { tokens.push_back(std::move(tok)); };
+
+            stream_tokenizer tokenizer;
+            tokenizer.feed(string_view(s).substr(0, split), emit);
+            tokenizer.feed(string_view(s).substr(split), emit);
+            tokenizer.finish(emit);
+            return tokens;
+        }
+
+    public:
+        TEST_METHOD(should_not_recognize_any_tokens_in_an_empty_stream)
+        {
+            istringstream in("");
+            vector<token> tokens;
+            tokenize(in, [&](token&& tok) { tokens.push_back(std::move(tok)); });
+            _(tokens).should_be_empty();
+        }
+
+        TEST_METHOD(should_recognize_tokens_split_at_every_chunk_boundary)
+        {
+            string s = "[*] ---(name)-- [ab c]\\ |(x)/";
+            for (size_t split = 0; split <= s.size(); ++split)
+            {
+                _(tokenize_in_chunks(s, split)).should_equal({ root_node(), horizontal_edge("name"),
+                    named_node("ab c"), descending_edge_part(), vertical_edge_part(), edge_name("x"), ascending_edge_part() });
+            }
+        }
+
+        TEST_METHOD(should_emit_a_token_before_the_stream_ends_once_it_cannot_change)
+        {
+            vector<token> tokens;
+            stream_tokenizer tokenizer;
+            tokenizer.feed("[*]-(a)", [&](token&& tok) { tokens.push_back(std::move(tok)); });
+            tokenizer.feed("-[b", [&](token&& tok) { tokens.push_back(std::move(tok)); });
+            _(tokens).should_equal({ root_node(), horizontal_edge("a") });
+            _(tokenizer.offset()).should_be(8u);
+        }
+
+        TEST_METHOD(should_not_carry_the_dashes_and_spaces_after_a_horizontal_edge)
+        {
+            vector<token> tokens;
+            auto emit = [&](token&& tok) { tokens.push_back(std::move(tok)); };
+            stream_tokenizer tokenizer;
+            tokenizer.feed("[*]-(a)-", emit);
+            _(tokens).should_equal({ root_node(), horizontal_edge("a") });
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                tokenizer.feed("- - ", emit);
+                _(tokenizer.offset()).should_be(8u + 4 * (i + 1));
+            }
+            tokenizer.feed("  [b]", emit);
+            tokenizer.finish(emit);
+            _(tokens).should_equal({ root_node(), horizontal_edge("a"), named_node("b") });
+        }
+
+        TEST_METHOD(should_hold_a_long_token_fed_a_char_at_a_time_until_it_ends)
+        {
+            vector<token> tokens;
+            auto emit = [&](token&& tok) { tokens.push_back(std::move(tok)); };
+            stream_tokenizer tokenizer;
+            tokenizer.feed("[*]", emit);
+            for (int i = 0; i < 1000; ++i) { tokenizer.feed("-", emit); }
+            for (char ch : string("(a)")) { tokenizer.feed(string_view(&ch, 1), emit); }
+            _(tokens).should_equal({ root_node() });
+            _(tokenizer.offset()).should_be(3u);
+
+            tokenizer.feed("-", emit);
+            _(tokens).should_equal({ root_node(), horizontal_edge("a") });
+            _(tokenizer.offset()).should_be(1007u);
+
+            tokenizer.feed("[b]", emit);
+            tokenizer.finish(emit);
+            _(tokens).should_equal({ root_node(), horizontal_edge("a"), named_node("b") });
+        }
+
+        TEST_METHOD(should_report_an_error_inside_a_held_token_at_its_offset)
+        {
+            stream_tokenizer tokenizer;
+            tokenizer.feed("[*]", [](token&&) {});
+            for (int i = 0; i < 100; ++i) { tokenizer.feed("-", [](token&&) {}); }
+            try
+            {
+                tokenizer.feed("]", [](token&&) {});
+                Microsoft::VisualStudio::CppUnitTestFramework::Assert::Fail(L"Should have thrown");
+            }
+            catch (parse_exception& e)
+            {
+                _(e.pos).should_be(103u);
+            }
+        }
+
+        TEST_METHOD(should_read_an_istream_in_small_chunks)
+        {
+            istringstream in("[*]------(edge)------[child]  ");
+            vector<token> tokens;
+            tokenize(in, [&](token&& tok) { tokens.push_back(std::move(tok)); }, 3);
+            _(tokens).should_equal({ root_node(), horizontal_edge("edge"), named_node("child") });
+        }
+
+        TEST_METHOD(should_report_an_error_at_its_offset_in_the_whole_stream)
+        {
+            istringstream in("[*] [a] ]");
+            try
+            {
+                tokenize(in, [](token&&) {}, 4);
+                Microsoft::VisualStudio::CppUnitTestFramework::Assert::Fail(L"Should have thrown");
+            }
+            catch (parse_exception& e)
+            {
+                _(e.pos).should_be(8u);
+            }
+        }
+
+        TEST_METHOD(should_reject_a_token_left_incomplete_at_the_end_of_the_stream)
+        {
+            istringstream in("[*]-(a");
+            try
+            {
+                tokenize(in, [](token&&) {}, 2);
+                Microsoft::VisualStudio::CppUnitTestFramework::Assert::Fail(L"Should have thrown");
+            }
+            catch (parse_exception& e)
+            {
+                _(e.pos).should_be(6u);
+            }
+        }
+    };
+}}
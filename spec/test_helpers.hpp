@@ -32,7 +32,7 @@ namespace Microsoft { namespace VisualStudio { namespace CppUnitTestFramework
             return L"slash";
         case backslash:
             return L"backslash";
-        case pipe:
+        case ascii_tree::pipe:
             return L"pipe";
         default:
             return L"unknown char";
@@ -0,0 +1,389 @@
+#if !defined(ASCII_TREE_STATIC_TREE_H)
+#define ASCII_TREE_STATIC_TREE_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include "grammar.hpp"
+#include "parser.hpp"
+#include "tree.hpp"
+
+// Diagrams fixed in the source can be tokenized, checked and linked into a tree
+// while compiling, by the same rules as grammar and tree (see tree.hpp):
+//
+//     constexpr auto t = ascii_tree::make_static_tree("[*]-(a)-[b]");
+//
+// or, where C++20 class-type template arguments are available,
+//
+//     using namespace ascii_tree::literals;
+//     constexpr auto& t = "[*]-(a)-[b]"_tree;
+//
+// A static_tree holds its tokens, nodes and a copy of the text in fixed-size
+// arrays, so it never allocates, and a constexpr one costs nothing at startup.
+// A malformed literal fails the build.
+
+namespace ascii_tree
+{
+    // Deliberately not constexpr: a diagram that reaches this while it is being
+    // parsed at compile time is not a constant expression, so the build fails
+    // with a diagnostic that names this function. At run time it reports the
+    // error like tree does.
+    [[noreturn]] inline void invalid_diagram_literal(std::string_view source, size_t pos)
+    {
+#if defined(ASCII_TREE_EXCEPTIONS)
+        throw parse_exception(std::string(source), pos);
+#else
+        (void)source;
+        (void)pos;
+        std::abort();
+#endif
+    }
+
+    // N is the length of the diagram; every array is sized for the worst case
+    // of one token per char
+    template<size_t N>
+    class static_tree
+    {
+    public:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        template<class T>
+        class range
+        {
+            const T* begin_;
+            const T* end_;
+
+        public:
+            constexpr range(const T* begin, const T* end) : begin_(begin), end_(end) {}
+
+            constexpr const T* begin() const { return begin_; }
+            constexpr const T* end() const { return end_; }
+            constexpr size_t size() const { return end_ - begin_; }
+            constexpr bool empty() const { return begin_ == end_; }
+            constexpr const T& operator[](size_t i) const { return begin_[i]; }
+        };
+
+    private:
+        struct name_span
+        {
+            size_t offset;
+            size_t length;
+        };
+
+        char source_[N + 1] = {};
+        size_t size_ = 0;
+        located_token tokens_[N + 1] = {};
+        size_t token_count_ = 0;
+        size_t root_ = npos;
+        size_t node_count_ = 0;
+        size_t parent_[N + 1] = {};
+        size_t child_begin_[N + 2] = {}; // node n's children are children_[child_begin_[n], child_begin_[n + 1])
+        size_t children_[N + 1] = {};
+        name_span names_[N + 1] = {};
+        name_span edge_names_[N + 1] = {};
+
+        class builder_;
+
+    public:
+        explicit constexpr static_tree(std::string_view source);
+
+        constexpr std::string_view source() const
+        {
+            return std::string_view(source_, size_);
+        }
+
+        constexpr range<located_token> tokens() const
+        {
+            return range<located_token>(tokens_, tokens_ + token_count_);
+        }
+
+        constexpr std::string_view name(const token_ref& ref) const
+        {
+            return source().substr(ref.offset, ref.length);
+        }
+
+        constexpr size_t size() const
+        {
+            return node_count_;
+        }
+
+        constexpr bool empty() const
+        {
+            return node_count_ == 0;
+        }
+
+        constexpr size_t root() const
+        {
+            return root_;
+        }
+
+        constexpr size_t parent(size_t node) const
+        {
+            return parent_[node];
+        }
+
+        constexpr range<size_t> children(size_t node) const
+        {
+            return range<size_t>(children_ + child_begin_[node], children_ + child_begin_[node + 1]);
+        }
+
+        constexpr std::string_view name(size_t node) const
+        {
+            return source().substr(names_[node].offset, names_[node].length);
+        }
+
+        // the name of the edge from the node's parent, or empty if it has none
+        constexpr std::string_view edge_name(size_t node) const
+        {
+            return source().substr(edge_names_[node].offset, edge_names_[node].length);
+        }
+    };
+
+    // a constexpr mirror of grammar's rules, which links the tokens with the
+    // same tree_linker as tree; positions are offsets into the whole diagram
+    template<size_t N>
+    class static_tree<N>::builder_
+    {
+        static_tree& t_;
+        std::string_view s_;
+        size_t rows_ = 0;
+        size_t row_begin_[N + 2] = {}; // row r's tokens are tokens_[row_begin_[r], row_begin_[r + 1])
+        size_t row_offset_[N + 2] = {};
+        size_t node_of_[N + 1] = {};
+        size_t token_of_[N + 1] = {};
+        unsigned char used_[N + 1] = {};
+        size_t edge_name_token_[N + 1] = {};
+
+        // not constexpr either, for the same reason as invalid_diagram_literal
+        void error_(size_t pos) const
+        {
+            invalid_diagram_literal(s_, pos);
+        }
+
+        void error_at_token_(size_t tok) const
+        {
+            error_(row_offset_[t_.tokens_[tok].row] + t_.tokens_[tok].column);
+        }
+
+        constexpr terminal term_(size_t i, size_t end) const
+        {
+            return i < end ? terminal_traits::classify(s_[i]) : none;
+        }
+
+        constexpr size_t skip_(size_t i, size_t end, terminal term) const
+        {
+            while (i < end && (term_(i, end) == term || term_(i, end) == space)) { ++i; }
+            return i;
+        }
+
+        constexpr size_t trim_(size_t begin, size_t end) const
+        {
+            while (end > begin && s_[end - 1] == ' ') { --end; }
+            return end;
+        }
+
+        constexpr void expect_(size_t& i, size_t end, terminal term) const
+        {
+            i = skip_(i, end, space);
+            if (term_(i, end) != term) { error_(i); }
+            ++i;
+        }
+
+        constexpr name_span expect_name_chars_(size_t& i, size_t end) const
+        {
+            expect_(i, end, name_char);
+            size_t begin = i - 1;
+            i = trim_(begin, skip_(i, end, name_char));
+            return name_span{ begin, i - begin };
+        }
+
+        constexpr token_ref named_(token::toktype type, name_span name) const
+        {
+            return token_ref{ type, name.offset, name.length };
+        }
+
+        constexpr void tokenize_line_(size_t row, size_t i, size_t end)
+        {
+            for (;;)
+            {
+                i = skip_(i, end, space);
+                if (i == end) { return; }
+
+                size_t start = i;
+                token_ref ref{ token::root_node, start, 0 };
+                switch (term_(i, end))
+                {
+                case open_square_brace:
+                    ++i;
+                    if (term_(skip_(i, end, space), end) == asterisk)
+                    {
+                        expect_(i, end, asterisk);
+                        expect_(i, end, close_square_brace);
+                    }
+                    else
+                    {
+                        ref = named_(token::named_node, expect_name_chars_(i, end));
+                        expect_(i, end, close_square_brace);
+                    }
+                    break;
+                case dash:
+                    i = skip_(i, end, dash);
+                    expect_(i, end, open_paren);
+                    ref = named_(token::horizontal_edge, expect_name_chars_(i, end));
+                    expect_(i, end, close_paren);
+                    expect_(i, end, dash);
+                    i = skip_(i, end, dash);
+                    break;
+                case open_paren:
+                    ++i;
+                    ref = named_(token::edge_name, expect_name_chars_(i, end));
+                    expect_(i, end, close_paren);
+                    break;
+                case slash:
+                    ref.type = token::ascending_edge_part;
+                    ++i;
+                    break;
+                case backslash:
+                    ref.type = token::descending_edge_part;
+                    ++i;
+                    break;
+                case pipe:
+                    ref.type = token::vertical_edge_part;
+                    ++i;
+                    break;
+                default:
+                    error_(i);
+                }
+
+                size_t column = start - row_offset_[row];
+                t_.tokens_[t_.token_count_++] = located_token{ ref, row, column, trim_(start, i) - start };
+            }
+        }
+
+        constexpr void tokenize_()
+        {
+            size_t begin = 0;
+            for (;;)
+            {
+                size_t end = s_.find('\n', begin);
+                bool last = end == std::string_view::npos;
+                if (last) { end = s_.size(); }
+
+                row_offset_[rows_] = begin;
+                size_t content_end = end > begin && s_[end - 1] == '\r' ? end - 1 : end;
+                tokenize_line_(rows_, begin, content_end);
+                row_begin_[++rows_] = t_.token_count_;
+
+                if (last) { return; }
+                begin = end + 1;
+            }
+        }
+
+        constexpr name_span name_of_(size_t tok) const
+        {
+            if (tok == npos) { return name_span{ 0, 0 }; }
+            const token_ref& ref = t_.tokens_[tok].ref;
+            return name_span{ ref.offset, ref.length };
+        }
+
+        constexpr void build_children_()
+        {
+            size_t n = t_.node_count_;
+            for (size_t node = 0; node < n; ++node)
+            {
+                if (t_.parent_[node] != npos) { ++t_.child_begin_[t_.parent_[node] + 1]; }
+            }
+            for (size_t node = 0; node < n; ++node)
+            {
+                t_.child_begin_[node + 1] += t_.child_begin_[node];
+            }
+
+            // edge_name_token_ is done with, so it holds each node's next child slot
+            for (size_t node = 0; node < n; ++node)
+            {
+                edge_name_token_[node] = t_.child_begin_[node];
+            }
+            for (size_t node = 0; node < n; ++node)
+            {
+                if (t_.parent_[node] != npos) { t_.children_[edge_name_token_[t_.parent_[node]]++] = node; }
+            }
+        }
+
+    public:
+        constexpr builder_(static_tree& t) : t_(t), s_(t.source()) {}
+
+        constexpr void build()
+        {
+            tokenize_();
+
+            tree_linker linker{ t_.tokens_, t_.token_count_, row_begin_, rows_, node_of_, token_of_, used_,
+                t_.parent_, edge_name_token_ };
+            size_t error = linker.number_nodes();
+            if (error == npos) { error = linker.link(); }
+            if (error != npos) { error_at_token_(error); }
+
+            t_.root_ = linker.root;
+            t_.node_count_ = linker.node_count;
+            for (size_t node = 0; node < t_.node_count_; ++node)
+            {
+                t_.names_[node] = name_of_(token_of_[node]);
+                t_.edge_names_[node] = name_of_(edge_name_token_[node]);
+            }
+
+            build_children_();
+        }
+    };
+
+    template<size_t N>
+    constexpr static_tree<N>::static_tree(std::string_view source)
+    {
+        if (source.size() > N) { invalid_diagram_literal(source, N); }
+
+        size_ = source.size();
+        for (size_t i = 0; i < size_; ++i)
+        {
+            source_[i] = source[i];
+        }
+
+        builder_(*this).build();
+    }
+
+    template<size_t N>
+    constexpr static_tree<N - 1> make_static_tree(const char (&diagram)[N])
+    {
+        return static_tree<N - 1>(std::string_view(diagram, N - 1));
+    }
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    namespace literals
+    {
+        // a string literal as a template argument
+        template<size_t N>
+        struct diagram_literal
+        {
+            char chars[N] = {};
+
+            constexpr diagram_literal(const char (&diagram)[N])
+            {
+                for (size_t i = 0; i < N; ++i)
+                {
+                    chars[i] = diagram[i];
+                }
+            }
+        };
+
+        template<diagram_literal Diagram>
+        inline constexpr auto static_tree_v = make_static_tree(Diagram.chars);
+
+        // one static_tree per distinct literal, built while compiling
+        template<diagram_literal Diagram>
+        constexpr const auto& operator""_tree()
+        {
+            return static_tree_v<Diagram>;
+        }
+    }
+#endif
+}
+
+#endif // ASCII_TREE_STATIC_TREE_H
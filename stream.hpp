@@ -0,0 +1,216 @@
+#if !defined(ASCII_TREE_STREAM_H)
+#define ASCII_TREE_STREAM_H
+
+#include <cerrno>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "box_drawing.hpp"
+#include "dfa_lexer.hpp"
+#include "grammar.hpp"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ascii_tree
+{
+    // Tokenizes input that arrives in chunks of any size. A token that may
+    // still continue into the next chunk (e.g. a half-read "---(name)--") is
+    // carried over, so memory stays bounded by the chunk size plus the longest
+    // token rather than by the size of the whole input. A horizontal edge is
+    // emitted as soon as its ')' and a trailing '-' are in; the '-' and ' '
+    // that may follow it only lengthen it, so they are dropped as they arrive.
+    //
+    // While a token is held, each chunk is run through dfa_lexer's state
+    // machine from where the last one left off, and the carry is tokenized
+    // again only once the machine says the token has ended or gone wrong. So
+    // a long token fed a few chars at a time costs O(its length) in all, not
+    // O(its length) per chunk.
+    //
+    // A parse_exception thrown from here reports pos as an offset into the
+    // whole input and s as the text that was buffered when the error was found.
+    // Box-drawing chars are turned into ASCII as they arrive (see
+    // box_drawing.hpp), so those offsets count each of them as one char.
+    class stream_tokenizer
+    {
+        std::string carry_;
+        size_t carry_offset_;
+        std::string split_; // the start of a UTF-8 sequence that the next chunk finishes
+        bool in_edge_tail_; // the last token emitted was a horizontal edge that reached the end of the input
+        dfa_table::state held_; // the machine's state at the end of the carry while a token is held, else start
+        size_t checked_;        // how much of the carry the machine has read
+
+        // whether a token in this state may still grow, or go wrong; a horizontal
+        // edge that has reached its trailing '-' is done (see skip_edge_tail_)
+        static bool unfinished_(dfa_table::state state)
+        {
+            return state < dfa_table::live_states && state != dfa_table::horizontal_tail;
+        }
+
+        // runs the machine from state over the carry from checked_ on, while
+        // the token is unfinished
+        dfa_table::state advance_(dfa_table::state state)
+        {
+            for (; checked_ < carry_.size() && unfinished_(state); ++checked_)
+            {
+                state = dfa_table::table[state][terminal_traits::to_terminal(carry_[checked_])];
+            }
+            return state;
+        }
+
+        void append_(std::string_view chunk)
+        {
+            if (split_.empty() && is_ascii(chunk))
+            {
+                carry_.append(chunk.data(), chunk.size());
+                return;
+            }
+
+            split_.append(chunk.data(), chunk.size());
+            std::string_view text(split_);
+            text.remove_suffix(incomplete_utf8_suffix(text));
+            carry_ += ascii_from_box_drawing(text);
+            split_.erase(0, text.size());
+        }
+
+        void skip_edge_tail_()
+        {
+            size_t tail = carry_.find_first_not_of("- ");
+            if (tail == std::string::npos) { tail = carry_.size(); }
+            else { in_edge_tail_ = false; }
+
+            carry_.erase(0, tail);
+            carry_offset_ += tail;
+        }
+
+        template<class Emit>
+        void drain_(Emit& emit, bool at_eof)
+        {
+            if (in_edge_tail_) { skip_edge_tail_(); }
+
+            if (held_ != dfa_table::start)
+            {
+                if (!at_eof && unfinished_(held_ = advance_(held_))) { return; }
+                held_ = dfa_table::start;
+            }
+
+            grammar g{ std::string_view(carry_) };
+            size_t consumed = 0;
+            bool held = false;
+
+            token_ref ref{};
+            while (g.next(ref))
+            {
+                if (!at_eof && g.offset() == carry_.size())
+                {
+                    if (ref.type != token::horizontal_edge)
+                    {
+                        held = true; // the next chunk may extend this token
+                        break;
+                    }
+                    in_edge_tail_ = true;
+                }
+
+                emit(g.to_token(ref));
+                consumed = g.offset();
+            }
+
+            if (g.failed())
+            {
+                size_t pos = g.error().pos;
+                if (at_eof || pos != carry_.size())
+                {
+                    throw parse_exception(carry_, carry_offset_ + pos);
+                }
+
+                held = true; // ran out of input in the middle of a token
+            }
+
+            if (!held) { consumed = carry_.size(); }
+            carry_.erase(0, consumed);
+            carry_offset_ += consumed;
+
+            if (held)
+            {
+                checked_ = 0;
+                held_ = advance_(dfa_table::start);
+                if (!unfinished_(held_)) { held_ = dfa_table::start; } // tokenize it again next time
+            }
+        }
+
+    public:
+        stream_tokenizer() : carry_offset_(0), in_edge_tail_(false), held_(dfa_table::start), checked_(0) {}
+
+        // tokenizes as much of the input seen so far as can no longer change,
+        // calling emit(token) for each token in order
+        template<class Emit>
+        void feed(std::string_view chunk, Emit emit)
+        {
+            append_(chunk);
+            drain_(emit, false);
+        }
+
+        // tokenizes whatever was carried over from the last chunk
+        template<class Emit>
+        void finish(Emit emit)
+        {
+            carry_ += split_; // never finished, so it is an error wherever it ends up
+            split_.clear();
+            drain_(emit, true);
+        }
+
+        // the offset of the first char not yet tokenized
+        size_t offset() const
+        {
+            return carry_offset_;
+        }
+    };
+
+    template<class Emit>
+    void tokenize(std::istream& in, Emit emit, size_t chunk_size = 64 * 1024)
+    {
+        stream_tokenizer tokenizer;
+        std::vector<char> chunk(chunk_size);
+
+        while (in.read(chunk.data(), chunk.size()), in.gcount() > 0)
+        {
+            tokenizer.feed(std::string_view(chunk.data(), static_cast<size_t>(in.gcount())), emit);
+        }
+
+        tokenizer.finish(emit);
+    }
+
+    // reads a file descriptor (a file, a pipe, a socket) until end of file
+    template<class Emit>
+    void tokenize_fd(int fd, Emit emit, size_t chunk_size = 64 * 1024)
+    {
+        stream_tokenizer tokenizer;
+        std::vector<char> chunk(chunk_size);
+
+        for (;;)
+        {
+#if defined(_WIN32)
+            auto n = ::_read(fd, chunk.data(), static_cast<unsigned>(chunk.size()));
+#else
+            auto n = ::read(fd, chunk.data(), chunk.size());
+#endif
+            if (n < 0)
+            {
+                if (errno == EINTR) { continue; }
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if (n == 0) { break; }
+
+            tokenizer.feed(std::string_view(chunk.data(), static_cast<size_t>(n)), emit);
+        }
+
+        tokenizer.finish(emit);
+    }
+}
+
+#endif // ASCII_TREE_STREAM_H
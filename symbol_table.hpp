@@ -0,0 +1,120 @@
+#if !defined(ASCII_TREE_SYMBOL_TABLE_H)
+#define ASCII_TREE_SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ascii_tree
+{
+    typedef uint32_t symbol_id;
+
+    // Interns names: each distinct name is stored once, in one contiguous
+    // pool, and gets a small integer id, so names compare and hash as ids.
+    // Id 0 is always the empty name. Lookups go through an open-addressing
+    // hash table of ids, so no name is stored twice and nothing points into
+    // the pool while it grows.
+    class symbol_table
+    {
+        struct symbol_
+        {
+            size_t offset;
+            size_t length;
+            uint64_t hash;
+        };
+
+        static constexpr symbol_id empty_slot_ = static_cast<symbol_id>(-1);
+
+        std::string pool_;
+        std::vector<symbol_> symbols_;  // indexed by id
+        std::vector<symbol_id> slots_;  // a power of two in size, at most half full
+
+        // 64-bit FNV-1a
+        static uint64_t hash_(std::string_view name)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (char ch : name)
+            {
+                hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        size_t slot_of_(std::string_view name, uint64_t hash) const
+        {
+            size_t mask = slots_.size() - 1;
+            for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+            {
+                symbol_id id = slots_[slot];
+                if (id == empty_slot_ || (symbols_[id].hash == hash && this->name(id) == name))
+                {
+                    return slot;
+                }
+            }
+        }
+
+        void grow_()
+        {
+            std::vector<symbol_id> slots(slots_.size() * 2, empty_slot_);
+            slots_.swap(slots);
+            for (symbol_id id = 0; id < symbols_.size(); ++id)
+            {
+                size_t mask = slots_.size() - 1;
+                size_t slot = symbols_[id].hash & mask;
+                while (slots_[slot] != empty_slot_) { slot = (slot + 1) & mask; }
+                slots_[slot] = id;
+            }
+        }
+
+    public:
+        static constexpr symbol_id npos = empty_slot_;
+
+        symbol_table()
+            : slots_(16, empty_slot_)
+        {
+            intern("");
+        }
+
+        // the name's id, adding the name if it is new
+        symbol_id intern(std::string_view name)
+        {
+            uint64_t hash = hash_(name);
+            size_t slot = slot_of_(name, hash);
+            if (slots_[slot] != empty_slot_) { return slots_[slot]; }
+
+            symbol_id id = static_cast<symbol_id>(symbols_.size());
+            symbols_.push_back(symbol_{ pool_.size(), name.size(), hash });
+            pool_.append(name.data(), name.size());
+            slots_[slot] = id;
+
+            if (symbols_.size() * 2 > slots_.size()) { grow_(); }
+            return id;
+        }
+
+        // the name's id, or npos if it was never interned
+        symbol_id find(std::string_view name) const
+        {
+            return slots_[slot_of_(name, hash_(name))];
+        }
+
+        std::string_view name(symbol_id id) const
+        {
+            return std::string_view(pool_).substr(symbols_[id].offset, symbols_[id].length);
+        }
+
+        // the number of distinct names, the empty one included
+        size_t size() const
+        {
+            return symbols_.size();
+        }
+
+        // every interned name, back to back
+        std::string_view pool() const
+        {
+            return pool_;
+        }
+    };
+}
+
+#endif // ASCII_TREE_SYMBOL_TABLE_H
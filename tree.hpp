@@ -0,0 +1,462 @@
+#if !defined(ASCII_TREE_TREE_H)
+#define ASCII_TREE_TREE_H
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "grammar.hpp"
+#include "line_index.hpp"
+
+#if 0
+
+CONNECTING TOKENS INTO A TREE
+=============================
+
+A horizontal edge links the node just before it on its row (the parent) to
+the node just after it (the child):
+
+    [*]--(a)--[b]
+
+Any other edge starts on the row below its parent: a '|' under one of the
+columns of the parent, a '/' one column to its left or a backslash one column
+to its right. Each row down, the edge moves one column in the direction of its
+last part ('/' left, '|' straight, backslash right) and continues through
+whichever token covers that column: another edge part, at most one edge name,
+and finally the child node:
+
+        [*]
+       / | \
+    [a] (x) [c]
+         |
+        [b]
+
+Every node but the root must have exactly one parent, there must be exactly
+one root, and every edge part and edge name must belong to an edge.
+
+#endif
+
+namespace ascii_tree
+{
+    // Links located tokens, ordered by row and then by column, into a parent
+    // for each node by the rules above. tree and static_tree both build with
+    // it, so it works on plain arrays and in constant expressions. Every
+    // search of a row is a binary search, so linking takes O(tokens log
+    // tokens) however wide the rows are. Each step returns npos, or the index
+    // of the token at which the diagram is wrong.
+    struct tree_linker
+    {
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        const located_token* tokens;
+        size_t token_count;
+        const size_t* row_begin;        // row r's tokens are tokens[row_begin[r], row_begin[r + 1])
+        size_t rows;
+        size_t* node_of;                // token index -> node index, or npos
+        size_t* token_of;               // node index -> token index
+        unsigned char* used;            // token index -> whether it is part of the tree
+        size_t* parent = nullptr;       // node index -> parent node, or npos; set after number_nodes()
+        size_t* edge_name_token = nullptr; // node index -> token naming the edge from its parent, or npos
+        size_t root = npos;
+        size_t node_count = 0;
+
+        static constexpr bool is_node(const located_token& tok)
+        {
+            return tok.ref.type == token::root_node || tok.ref.type == token::named_node;
+        }
+
+        // numbers the nodes in diagram order; node_of, token_of and used must
+        // have room for token_count entries
+        constexpr size_t number_nodes()
+        {
+            for (size_t i = 0; i < token_count; ++i)
+            {
+                node_of[i] = npos;
+                used[i] = false;
+                if (!is_node(tokens[i])) { continue; }
+
+                if (tokens[i].ref.type == token::root_node)
+                {
+                    if (root != npos) { return i; }
+                    root = node_count;
+                }
+
+                node_of[i] = node_count;
+                token_of[node_count++] = i;
+                used[i] = true;
+            }
+            return npos;
+        }
+
+        // parent and edge_name_token must have room for node_count entries
+        constexpr size_t link()
+        {
+            for (size_t node = 0; node < node_count; ++node)
+            {
+                parent[node] = npos;
+                edge_name_token[node] = npos;
+            }
+
+            for (size_t i = 0; i < token_count; ++i)
+            {
+                if (tokens[i].ref.type != token::horizontal_edge) { continue; }
+                size_t error = link_horizontal_edge_(i);
+                if (error != npos) { return error; }
+            }
+
+            for (size_t node = 0; node < node_count; ++node)
+            {
+                size_t error = follow_edges_below_(token_of[node]);
+                if (error != npos) { return error; }
+            }
+
+            for (size_t i = 0; i < token_count; ++i)
+            {
+                if (!used[i]) { return i; }
+            }
+
+            for (size_t node = 0; node < node_count; ++node)
+            {
+                if (node != root && parent[node] == npos) { return token_of[node]; }
+            }
+            return npos;
+        }
+
+    private:
+        static constexpr int direction_(const located_token& tok)
+        {
+            return tok.ref.type == token::ascending_edge_part ? -1
+                : tok.ref.type == token::descending_edge_part ? 1
+                : 0;
+        }
+
+        // the first token on the row that ends after the column
+        constexpr size_t first_ending_after_(size_t row, size_t column) const
+        {
+            size_t lo = row_begin[row], hi = row_begin[row + 1];
+            while (lo < hi)
+            {
+                size_t mid = lo + (hi - lo) / 2;
+                if (tokens[mid].column + tokens[mid].length <= column) { lo = mid + 1; }
+                else { hi = mid; }
+            }
+            return lo;
+        }
+
+        // the token on the row that covers the column, or npos
+        constexpr size_t find_(size_t row, size_t column) const
+        {
+            if (row >= rows) { return npos; }
+
+            size_t i = first_ending_after_(row, column);
+            return i < row_begin[row + 1] && tokens[i].column <= column ? i : npos;
+        }
+
+        constexpr size_t link_(size_t parent_tok, size_t child_tok, size_t edge_name_tok)
+        {
+            size_t child = node_of[child_tok];
+            if (tokens[child_tok].ref.type == token::root_node || parent[child] != npos) { return child_tok; }
+
+            parent[child] = node_of[parent_tok];
+            edge_name_token[child] = edge_name_tok;
+            return npos;
+        }
+
+        constexpr size_t follow_(size_t parent_tok, size_t tok)
+        {
+            size_t name_tok = npos;
+            size_t row = tokens[tok].row;
+            size_t column = tokens[tok].column;
+            int direction = direction_(tokens[tok]);
+            used[tok] = true;
+
+            for (;;)
+            {
+                size_t target = column + direction;
+                size_t next = find_(row + 1, target);
+                if (next == npos) { return tok; }
+
+                const located_token& next_tok = tokens[next];
+                if (is_node(next_tok)) { return link_(parent_tok, next, name_tok); }
+
+                if (used[next] || next_tok.ref.type == token::horizontal_edge ||
+                    (next_tok.ref.type == token::edge_name && name_tok != npos))
+                {
+                    return next;
+                }
+
+                used[next] = true;
+                if (next_tok.ref.type == token::edge_name)
+                {
+                    name_tok = next;
+                    column = target;
+                }
+                else
+                {
+                    column = next_tok.column;
+                    direction = direction_(next_tok);
+                }
+
+                tok = next;
+                ++row;
+            }
+        }
+
+        // edges that leave the node downwards through the row below it; only
+        // the tokens from one column left of the node to one column right of
+        // it can start one
+        constexpr size_t follow_edges_below_(size_t node_tok)
+        {
+            const located_token& node = tokens[node_tok];
+            size_t row = node.row + 1;
+            if (row >= rows) { return npos; }
+
+            size_t left = node.column == 0 ? 0 : node.column - 1;
+            size_t right = node.column + node.length;
+            for (size_t i = first_ending_after_(row, left); i < row_begin[row + 1] && tokens[i].column <= right; ++i)
+            {
+                const located_token& tok = tokens[i];
+                bool starts_here =
+                    (tok.ref.type == token::vertical_edge_part &&
+                        tok.column >= node.column && tok.column < node.column + node.length) ||
+                    (tok.ref.type == token::ascending_edge_part && tok.column + 1 == node.column) ||
+                    (tok.ref.type == token::descending_edge_part && tok.column == right);
+
+                if (starts_here)
+                {
+                    if (used[i]) { return i; }
+                    size_t error = follow_(node_tok, i);
+                    if (error != npos) { return error; }
+                }
+            }
+            return npos;
+        }
+
+        constexpr size_t link_horizontal_edge_(size_t tok)
+        {
+            size_t left = tok - 1, right = tok + 1;
+            if (tok == 0 || right == token_count ||
+                tokens[left].row != tokens[tok].row || tokens[right].row != tokens[tok].row ||
+                !is_node(tokens[left]) || !is_node(tokens[right]))
+            {
+                return tok;
+            }
+
+            used[tok] = true;
+            return link_(left, right, tok);
+        }
+    };
+
+    // Nodes live in flat arrays indexed by node number (the order the nodes
+    // appear in the diagram); children are stored as CSR ranges, and every
+    // name is a span into one shared string pool.
+    class tree
+    {
+    public:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        class child_range
+        {
+            const size_t* begin_;
+            const size_t* end_;
+
+        public:
+            child_range(const size_t* begin, const size_t* end) : begin_(begin), end_(end) {}
+
+            const size_t* begin() const { return begin_; }
+            const size_t* end() const { return end_; }
+            size_t size() const { return end_ - begin_; }
+            bool empty() const { return begin_ == end_; }
+        };
+
+    private:
+        struct name_span
+        {
+            size_t offset;
+            size_t length;
+        };
+
+        size_t root_;
+        std::pmr::vector<size_t> parent_;
+        std::pmr::vector<size_t> child_begin_; // node n's children are children_[child_begin_[n], child_begin_[n + 1])
+        std::pmr::vector<size_t> children_;
+        std::pmr::vector<name_span> names_;
+        std::pmr::vector<name_span> edge_names_;
+        std::pmr::string pool_;
+
+        // appends a copy of name to pool_, even if an equal name is already
+        // there; binary_writer dedupes names when a tree is serialized
+        name_span store_name_(std::string_view name)
+        {
+            name_span span{ pool_.size(), name.size() };
+            pool_.append(name.data(), name.size());
+            return span;
+        }
+
+        class builder_;
+
+    public:
+        // a tree with no nodes, e.g. the value of a failed try_build()
+        explicit tree(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : root_(npos), parent_(resource), child_begin_(resource), children_(resource),
+            names_(resource), edge_names_(resource), pool_(resource)
+        {}
+
+        // every array, and all the scratch space used to build them, comes from
+        // the resource, so a monotonic resource can release a whole tree at once
+        static parse_result<tree> try_build(grammar& g, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+        // same as try_build(), but throws a parse_exception if the diagram
+        // has a bad token or an edge that does not link two nodes
+        explicit tree(grammar& g, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+#endif
+
+        size_t size() const
+        {
+            return parent_.size();
+        }
+
+        bool empty() const
+        {
+            return parent_.empty();
+        }
+
+        size_t root() const
+        {
+            return root_;
+        }
+
+        size_t parent(size_t node) const
+        {
+            return parent_[node];
+        }
+
+        child_range children(size_t node) const
+        {
+            const size_t* base = children_.data();
+            return child_range(base + child_begin_[node], base + child_begin_[node + 1]);
+        }
+
+        std::string_view name(size_t node) const
+        {
+            return std::string_view(pool_).substr(names_[node].offset, names_[node].length);
+        }
+
+        // the name of the edge from the node's parent, or empty if it has none
+        std::string_view edge_name(size_t node) const
+        {
+            return std::string_view(pool_).substr(edge_names_[node].offset, edge_names_[node].length);
+        }
+    };
+
+    class tree::builder_
+    {
+        tree& t_;
+        std::string_view source_;
+        line_index lines_;
+        std::pmr::vector<located_token> tokens_;
+        std::pmr::vector<size_t> row_begin_;
+        std::pmr::vector<size_t> node_of_;
+        std::pmr::vector<size_t> token_of_;
+        std::pmr::vector<unsigned char> used_;
+        std::pmr::vector<size_t> edge_name_token_;
+
+        // the offset of the token in the input
+        size_t offset_of_(size_t tok) const
+        {
+            return lines_.line_begin(tokens_[tok].row) + tokens_[tok].column;
+        }
+
+        void build_children_()
+        {
+            size_t n = t_.parent_.size();
+            t_.child_begin_.assign(n + 1, 0);
+            for (size_t node = 0; node < n; ++node)
+            {
+                if (t_.parent_[node] != npos) { ++t_.child_begin_[t_.parent_[node] + 1]; }
+            }
+            for (size_t node = 0; node < n; ++node)
+            {
+                t_.child_begin_[node + 1] += t_.child_begin_[node];
+            }
+
+            // walking children in node order keeps each child list in diagram order
+            std::pmr::vector<size_t> next(t_.child_begin_.begin(), t_.child_begin_.end() - 1, t_.child_begin_.get_allocator());
+            t_.children_.resize(t_.child_begin_[n]);
+            for (size_t node = 0; node < n; ++node)
+            {
+                if (t_.parent_[node] != npos) { t_.children_[next[t_.parent_[node]]++] = node; }
+            }
+        }
+
+    public:
+        builder_(tree& t, grammar& g, std::pmr::vector<located_token>&& tokens, std::pmr::memory_resource* resource)
+            : t_(t), source_(g.source()), lines_(source_, resource), tokens_(std::move(tokens)),
+            row_begin_(resource), node_of_(resource), token_of_(resource), used_(resource), edge_name_token_(resource)
+        {}
+
+        // returns the offset of the first token that is not linked into the
+        // tree, or npos
+        size_t build(grammar& g)
+        {
+            row_begin_.assign(lines_.rows() + 1, 0);
+            for (auto& tok : tokens_) { ++row_begin_[tok.row + 1]; }
+            for (size_t row = 0; row < lines_.rows(); ++row) { row_begin_[row + 1] += row_begin_[row]; }
+
+            node_of_.resize(tokens_.size());
+            token_of_.resize(tokens_.size());
+            used_.resize(tokens_.size());
+            tree_linker linker{ tokens_.data(), tokens_.size(), row_begin_.data(), lines_.rows(),
+                node_of_.data(), token_of_.data(), used_.data() };
+
+            size_t error = linker.number_nodes();
+            if (error != npos) { return offset_of_(error); }
+
+            t_.root_ = linker.root;
+            t_.parent_.resize(linker.node_count);
+            edge_name_token_.resize(linker.node_count);
+            linker.parent = t_.parent_.data();
+            linker.edge_name_token = edge_name_token_.data();
+
+            error = linker.link();
+            if (error != npos) { return offset_of_(error); }
+
+            t_.names_.reserve(linker.node_count);
+            t_.edge_names_.reserve(linker.node_count);
+            for (size_t node = 0; node < linker.node_count; ++node)
+            {
+                t_.names_.push_back(t_.store_name_(g.name(tokens_[token_of_[node]].ref)));
+                size_t name_tok = edge_name_token_[node];
+                t_.edge_names_.push_back(name_tok == npos
+                    ? name_span{ t_.pool_.size(), 0 }
+                    : t_.store_name_(g.name(tokens_[name_tok].ref)));
+            }
+
+            build_children_();
+            return npos;
+        }
+    };
+
+    inline parse_result<tree> tree::try_build(grammar& g, std::pmr::memory_resource* resource)
+    {
+        auto tokens = g.try_located_tokens(resource);
+        if (!tokens) { return parse_result<tree>(tokens.error()); }
+
+        tree t(resource);
+        size_t error = builder_(t, g, std::move(tokens.value()), resource).build(g);
+        if (error != npos) { return parse_result<tree>(make_parse_error(g.source(), error)); }
+        return parse_result<tree>(std::move(t));
+    }
+
+#if defined(ASCII_TREE_EXCEPTIONS)
+    inline tree::tree(grammar& g, std::pmr::memory_resource* resource)
+        : tree(resource)
+    {
+        size_t error = builder_(*this, g, g.located_tokens(resource), resource).build(g);
+        if (error != npos) { throw parse_exception(std::string(g.source()), error); }
+    }
+#endif
+}
+
+#endif // ASCII_TREE_TREE_H